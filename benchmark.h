@@ -0,0 +1,1117 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "vector.h"
+#include "incremental_vector.h"
+#include "concurrent_queue.h"
+#include "string_vector.h"
+#include "views.h"
+#include "vector_expr.h"
+#include "sort.h"
+#include "indexed_vector.h"
+#include "static_vector.h"
+#include "matrix.h"
+#include "bulk_loader.h"
+#include "perf_counters.h"
+#include "sharded_collector.h"
+#include "dary_heap.h"
+#include "search_index.h"
+#include "tracked_vector.h"
+#include "partition.h"
+#include "dict_vector.h"
+#include "parallel_construct.h"
+#include "trace_replay.h"
+
+using namespace std::literals;
+
+template <typename Func>
+double MeasureMilliseconds(Func&& func)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    func();
+    const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return elapsed.count();
+}
+
+// Times one variant of a benchmark and, where the hardware counters are
+// available, prints what that variant alone cost per operation.
+template <typename Func>
+double MeasureMilliseconds(std::string_view variant, uint64_t operations, Func&& func)
+{
+    static PerfCounters counters;
+    if (!counters.Available())
+    {
+        return MeasureMilliseconds(func);
+    }
+    counters.Start();
+    const double ms = MeasureMilliseconds(func);
+    PrintPerfSample(std::cerr, variant, counters.Stop(), operations);
+    return ms;
+}
+
+// Power-of-two buckets of nanoseconds: bucket i counts samples in [2^i, 2^(i+1)).
+class LatencyHistogram
+{
+public:
+    static constexpr size_t kBuckets = 40;
+
+    void Add(std::chrono::nanoseconds latency) noexcept;
+    void Merge(const LatencyHistogram& other) noexcept;
+
+    uint64_t Count() const noexcept;
+    uint64_t Max() const noexcept;
+
+    // Upper bound of the bucket that contains the given quantile.
+    uint64_t Quantile(double q) const noexcept;
+
+    void Print(std::ostream& out, std::string_view name) const;
+
+private:
+    uint64_t buckets_[kBuckets] = {};
+    uint64_t count_ = 0;
+    uint64_t max_ = 0;
+};
+
+inline void LatencyHistogram::Add(std::chrono::nanoseconds latency) noexcept
+{
+    uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+    size_t bucket = 0;
+    while (bucket + 1 < kBuckets && (ns >> (bucket + 1)) != 0)
+    {
+        ++bucket;
+    }
+    ++buckets_[bucket];
+    ++count_;
+    max_ = std::max(max_, ns);
+}
+
+inline void LatencyHistogram::Merge(const LatencyHistogram& other) noexcept
+{
+    for (size_t i = 0; i < kBuckets; ++i)
+    {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+}
+
+inline uint64_t LatencyHistogram::Count() const noexcept
+{
+    return count_;
+}
+
+inline uint64_t LatencyHistogram::Max() const noexcept
+{
+    return max_;
+}
+
+inline uint64_t LatencyHistogram::Quantile(double q) const noexcept
+{
+    const uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count_));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i)
+    {
+        seen += buckets_[i];
+        if (seen > rank)
+        {
+            // The bucket bound can overshoot every sample that landed in it.
+            return std::min(uint64_t{ 2 } << i, max_);
+        }
+    }
+    return max_;
+}
+
+inline void LatencyHistogram::Print(std::ostream& out, std::string_view name) const
+{
+    out << name << ": ops "sv << count_
+        << ", p50 <= "sv << Quantile(0.5) << "ns"sv
+        << ", p99 <= "sv << Quantile(0.99) << "ns"sv
+        << ", p99.99 <= "sv << Quantile(0.9999) << "ns"sv
+        << ", max "sv << max_ << "ns"sv << std::endl;
+}
+
+template <typename Container>
+LatencyHistogram MeasurePushBackLatency(std::string_view variant, size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+    LatencyHistogram histogram;
+    Container container;
+    MeasureMilliseconds(variant, count, [&]() {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto start = Clock::now();
+            container.PushBack(static_cast<uint64_t>(i));
+            histogram.Add(Clock::now() - start);
+        }
+        });
+    return histogram;
+}
+
+inline void BenchmarkIncrementalGrowth()
+{
+    using namespace std;
+    const size_t NUM = size_t{ 1 } << 24;
+    cerr << "PushBack latency, "sv << NUM << " elements:"sv << endl;
+    MeasurePushBackLatency<Vector<uint64_t>>("Vector PushBack"sv, NUM).Print(cerr, "Vector"sv);
+    MeasurePushBackLatency<IncrementalVector<uint64_t>>("IncrementalVector PushBack"sv, NUM).Print(cerr, "IncrementalVector"sv);
+}
+
+// Baseline the lock-free queues are compared against.
+template <typename T>
+class MutexQueue
+{
+public:
+    bool TryPush(T&& value)
+    {
+        std::lock_guard lock(mutex_);
+        queue_.push(std::move(value));
+        return true;
+    }
+
+    bool TryPop(T& out)
+    {
+        std::lock_guard lock(mutex_);
+        if (queue_.empty())
+        {
+            return false;
+        }
+        out = std::move(queue_.front());
+        queue_.pop();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::queue<T> queue_;
+};
+
+struct QueueRun
+{
+    double ns_per_item = 0;
+    // Time from a producer's push until a consumer popped the item.
+    LatencyHistogram latency;
+};
+
+// Runs `threads` producers and as many consumers. Every item carries the time it
+// was pushed, so each consumer also records its enqueue -> dequeue latency.
+template <typename Queue>
+QueueRun MeasureQueueThroughput(std::string_view variant, Queue& queue, size_t threads, size_t items_per_producer)
+{
+    using Clock = std::chrono::steady_clock;
+    std::atomic<size_t> consumed{ 0 };
+    const size_t total = threads * items_per_producer;
+    std::vector<LatencyHistogram> latencies(threads);
+    const auto start = Clock::now();
+    const auto since_start = [start]() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    };
+    const double ms = MeasureMilliseconds(variant, total, [&]() {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&queue, &since_start, items_per_producer]() {
+                for (size_t i = 0; i < items_per_producer; ++i)
+                {
+                    uint64_t pushed_at = since_start();
+                    while (!queue.TryPush(std::move(pushed_at)))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                });
+            workers.emplace_back([&queue, &consumed, &since_start, &latency = latencies[t], total]() {
+                uint64_t pushed_at = 0;
+                while (consumed.load(std::memory_order_relaxed) < total)
+                {
+                    if (queue.TryPop(pushed_at))
+                    {
+                        latency.Add(std::chrono::nanoseconds(since_start() - pushed_at));
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        });
+    QueueRun run;
+    run.ns_per_item = ms * 1e6 / static_cast<double>(total);
+    for (const LatencyHistogram& latency : latencies)
+    {
+        run.latency.Merge(latency);
+    }
+    return run;
+}
+
+inline void PrintQueueRun(std::ostream& out, std::string_view name, size_t threads, const QueueRun& run)
+{
+    out << name << " "sv << threads << "x"sv << threads << ": "sv << run.ns_per_item << " ns/item, latency p50 <= "sv
+        << run.latency.Quantile(0.5) << "ns, p99 <= "sv << run.latency.Quantile(0.99) << "ns, max "sv
+        << run.latency.Max() << "ns"sv << std::endl;
+}
+
+inline void BenchmarkQueues()
+{
+    using namespace std;
+    const size_t ITEMS = size_t{ 1 } << 20;
+    const size_t CAPACITY = 1024;
+    cerr << "Queue handoff, "sv << ITEMS << " items per producer:"sv << endl;
+    {
+        SpscQueue<uint64_t> spsc(CAPACITY);
+        PrintQueueRun(cerr, "SpscQueue"sv, 1, MeasureQueueThroughput("SpscQueue 1x1"sv, spsc, 1, ITEMS));
+    }
+    for (size_t threads : { 1, 2, 4 })
+    {
+        MpmcQueue<uint64_t> mpmc(CAPACITY);
+        MutexQueue<uint64_t> locked;
+        PrintQueueRun(cerr, "MpmcQueue"sv, threads, MeasureQueueThroughput("MpmcQueue"sv, mpmc, threads, ITEMS));
+        PrintQueueRun(cerr, "mutex + std::queue"sv, threads, MeasureQueueThroughput("mutex + std::queue"sv, locked, threads, ITEMS));
+    }
+}
+
+inline void BenchmarkStringVector()
+{
+    using namespace std;
+    const size_t NUM = 2'000'000;
+    Vector<string> strings;
+    strings.Reserve(NUM);
+    for (size_t i = 0; i < NUM; ++i)
+    {
+        strings.PushBack("key-"s + to_string(i * 2654435761u % 1'000'000'007u));
+    }
+    StringVector packed;
+    const double build_ms = MeasureMilliseconds("StringVector build"sv, NUM, [&]() { packed.Append(strings.begin(), strings.end()); });
+
+    size_t checksum = 0;
+    const double vector_scan_ms = MeasureMilliseconds("Vector<std::string> scan"sv, NUM, [&]() {
+        for (const string& s : strings)
+        {
+            checksum += s.size() + static_cast<unsigned char>(s.back());
+        }
+        });
+    const double packed_scan_ms = MeasureMilliseconds("StringVector scan"sv, NUM, [&]() {
+        for (size_t i = 0; i < packed.Size(); ++i)
+        {
+            checksum += packed[i].size() + static_cast<unsigned char>(packed[i].back());
+        }
+        });
+
+    size_t heap_bytes = 0;
+    for (const string& s : strings)
+    {
+        heap_bytes += s.capacity() > 15 ? s.capacity() + 1 : 0;
+    }
+    cerr << "Strings, "sv << NUM << " elements (checksum "sv << checksum << "):"sv << endl;
+    cerr << "Vector<std::string>: "sv << strings.MemoryFootprint().reserved_bytes + heap_bytes
+        << " bytes, scan "sv << vector_scan_ms << " ms"sv << endl;
+    cerr << "StringVector: "sv << packed.MemoryFootprint().reserved_bytes
+        << " bytes, scan "sv << packed_scan_ms << " ms, build "sv << build_ms << " ms"sv << endl;
+}
+
+inline void BenchmarkViews()
+{
+    using namespace std;
+    const size_t NUM = 10'000'000;
+    Vector<uint64_t> source(NUM);
+    for (size_t i = 0; i < NUM; ++i)
+    {
+        source[i] = i * 2654435761u;
+    }
+    const auto is_odd = [](uint64_t x) { return (x & 1) != 0; };
+    const auto scale = [](uint64_t x) { return static_cast<double>(x) * 0.5; };
+    const size_t TAKE = NUM / 4;
+
+    Vector<double> eager;
+    const double eager_ms = MeasureMilliseconds("eager Vector chain"sv, NUM, [&]() {
+        Vector<uint64_t> filtered;
+        for (uint64_t x : source)
+        {
+            if (is_odd(x))
+            {
+                filtered.PushBack(x);
+            }
+        }
+        Vector<double> mapped;
+        for (uint64_t x : filtered)
+        {
+            mapped.PushBack(scale(x));
+        }
+        for (size_t i = 0; i < std::min(TAKE, mapped.Size()); ++i)
+        {
+            eager.PushBack(mapped[i]);
+        }
+        });
+    Vector<double> fused;
+    const double fused_ms = MeasureMilliseconds("fused view"sv, NUM, [&]() {
+        fused = AsView(source).Filter(is_odd).Map(scale).Take(TAKE).Collect();
+        });
+    cerr << "Filter -> Map -> Take over "sv << NUM << " elements ("sv << fused.Size() << " results):"sv << endl;
+    cerr << "eager Vector chain: "sv << eager_ms << " ms, fused view: "sv << fused_ms << " ms"sv << endl;
+}
+
+inline void BenchmarkExpressions()
+{
+    using namespace std;
+    const size_t NUM = 10'000'000;
+    Vector<double> a(NUM);
+    Vector<double> b(NUM);
+    Vector<double> c(NUM);
+    for (size_t i = 0; i < NUM; ++i)
+    {
+        a[i] = static_cast<double>(i);
+        b[i] = 0.5;
+        c[i] = static_cast<double>(i % 7);
+    }
+    Vector<double> result(NUM);
+    const double temporaries_ms = MeasureMilliseconds("with temporaries"sv, NUM, [&]() {
+        Vector<double> product(NUM);
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            product[i] = b[i] * c[i];
+        }
+        Vector<double> sum(NUM);
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            sum[i] = a[i] + product[i];
+        }
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            result[i] = sum[i] * 2.0;
+        }
+        });
+    const double fused_ms = MeasureMilliseconds("expression template"sv, NUM, [&]() { Assign(result, (a + b * c) * 2.0); });
+    cerr << "(a + b * c) * 2 over "sv << NUM << " doubles (sum "sv << Sum(result) << "):"sv << endl;
+    cerr << "with temporaries: "sv << temporaries_ms << " ms, expression template: "sv << fused_ms << " ms"sv << endl;
+}
+
+struct SortRecord
+{
+    uint64_t key;
+    uint64_t payload;
+};
+
+inline void BenchmarkSorts()
+{
+    using namespace std;
+    uint64_t seed = 42;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return seed >> 1;
+    };
+    for (size_t size : { 100'000, 1'000'000, 10'000'000 })
+    {
+        for (string_view distribution : { "uniform"sv, "few unique"sv, "sorted"sv })
+        {
+            Vector<uint64_t> input(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                input[i] = distribution == "uniform"sv ? next()
+                    : distribution == "few unique"sv ? next() % 16
+                    : i;
+            }
+            Vector<uint64_t> v = input;
+            const double std_ms = MeasureMilliseconds("std::sort"sv, size, [&]() { std::sort(v.begin(), v.end()); });
+            v = input;
+            const double radix8_ms = MeasureMilliseconds("RadixSort<8>"sv, size, [&]() { RadixSort<8>(v); });
+            v = input;
+            const double radix16_ms = MeasureMilliseconds("RadixSort<16>"sv, size, [&]() { RadixSort<16>(v); });
+            v = input;
+            const double parallel_ms = MeasureMilliseconds("ParallelSort"sv, size, [&]() { ParallelSort(v); });
+            cerr << "sort "sv << size << " uint64 "sv << distribution << ": std::sort "sv << std_ms
+                << " ms, RadixSort<8> "sv << radix8_ms << " ms, RadixSort<16> "sv << radix16_ms
+                << " ms, ParallelSort "sv << parallel_ms << " ms"sv << endl;
+        }
+    }
+    {
+        const size_t size = 1'000'000;
+        Vector<SortRecord> input(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            input[i] = SortRecord{ next(), i };
+        }
+        const auto by_key = [](const SortRecord& lhs, const SortRecord& rhs) { return lhs.key < rhs.key; };
+        Vector<SortRecord> v = input;
+        const double std_ms = MeasureMilliseconds("std::sort records"sv, size, [&]() { std::sort(v.begin(), v.end(), by_key); });
+        v = input;
+        const double radix_ms = MeasureMilliseconds("RadixSortBy<11> records"sv, size, [&]() {
+            RadixSortBy<11>(v, [](const SortRecord& record) { return record.key; });
+            });
+        cerr << "sort "sv << size << " records by key: std::sort "sv << std_ms
+            << " ms, RadixSortBy<11> "sv << radix_ms << " ms"sv << endl;
+    }
+}
+
+inline void BenchmarkIndexedVector()
+{
+    using namespace std;
+    const size_t NUM = 1'000'000;
+    const auto key_of = [](const SortRecord& record) { return record.key; };
+    IndexedVector<SortRecord, decltype(key_of)> indexed(key_of);
+    unordered_map<uint64_t, SortRecord> map;
+    const double indexed_build_ms = MeasureMilliseconds("IndexedVector build"sv, NUM, [&]() {
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            indexed.PushBack(SortRecord{ i * 2654435761u, i });
+        }
+        });
+    const double map_build_ms = MeasureMilliseconds("std::unordered_map build"sv, NUM, [&]() {
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            map.emplace(i * 2654435761u, SortRecord{ i * 2654435761u, i });
+        }
+        });
+    uint64_t checksum = 0;
+    const double indexed_find_ms = MeasureMilliseconds("IndexedVector find"sv, NUM, [&]() {
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            checksum += indexed.Find((i * 7919 % NUM) * 2654435761u)->payload;
+        }
+        });
+    const double map_find_ms = MeasureMilliseconds("std::unordered_map find"sv, NUM, [&]() {
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            checksum += map.find((i * 7919 % NUM) * 2654435761u)->second.payload;
+        }
+        });
+    cerr << "Keyed lookup, "sv << NUM << " records (checksum "sv << checksum << "):"sv << endl;
+    cerr << "IndexedVector: build "sv << indexed_build_ms << " ms, find "sv << indexed_find_ms
+        << " ms; std::unordered_map: build "sv << map_build_ms << " ms, find "sv << map_find_ms << " ms"sv << endl;
+}
+
+// Fills a small container of at most 16 routing hops and sums it, many times over.
+template <typename Fill>
+double MeasureSmallContainer(std::string_view variant, size_t rounds, Fill fill, uint64_t& checksum)
+{
+    return MeasureMilliseconds(variant, rounds, [&]() {
+        for (size_t round = 0; round < rounds; ++round)
+        {
+            checksum += fill(round % 16 + 1);
+        }
+        });
+}
+
+inline void BenchmarkStaticVector()
+{
+    using namespace std;
+    const size_t ROUNDS = 2'000'000;
+    uint64_t checksum = 0;
+    const double static_ms = MeasureSmallContainer("StaticVector"sv, ROUNDS, [](size_t count) {
+        StaticVector<uint32_t, 16, OverflowPolicy::kUnchecked> hops;
+        for (size_t i = 0; i < count; ++i)
+        {
+            hops.PushBack(static_cast<uint32_t>(i * 3));
+        }
+        uint64_t sum = 0;
+        for (uint32_t hop : hops)
+        {
+            sum += hop;
+        }
+        return sum;
+        }, checksum);
+    const double array_ms = MeasureSmallContainer("std::array + counter"sv, ROUNDS, [](size_t count) {
+        array<uint32_t, 16> hops;
+        size_t size = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            hops[size++] = static_cast<uint32_t>(i * 3);
+        }
+        uint64_t sum = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            sum += hops[i];
+        }
+        return sum;
+        }, checksum);
+    const double vector_ms = MeasureSmallContainer("Vector"sv, ROUNDS, [](size_t count) {
+        Vector<uint32_t> hops;
+        for (size_t i = 0; i < count; ++i)
+        {
+            hops.PushBack(static_cast<uint32_t>(i * 3));
+        }
+        uint64_t sum = 0;
+        for (uint32_t hop : hops)
+        {
+            sum += hop;
+        }
+        return sum;
+        }, checksum);
+    cerr << "Up to 16 hops, build and sum (checksum "sv << checksum << "):"sv << endl;
+    cerr << "StaticVector: "sv << static_ms << " ms, std::array + counter: "sv << array_ms
+        << " ms, Vector: "sv << vector_ms << " ms"sv << endl;
+}
+
+inline void BenchmarkMatrix()
+{
+    using namespace std;
+    const size_t N = 384;
+    Matrix<double> a(N, N);
+    Matrix<double> b(N, N);
+    Vector<Vector<double>> nested_a(N);
+    Vector<Vector<double>> nested_b(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        nested_a[i].Resize(N);
+        nested_b[i].Resize(N);
+        for (size_t j = 0; j < N; ++j)
+        {
+            a(i, j) = nested_a[i][j] = static_cast<double>((i + j) % 13);
+            b(i, j) = nested_b[i][j] = static_cast<double>((i * j) % 11);
+        }
+    }
+    double checksum = 0.0;
+    const double matrix_ms = MeasureMilliseconds("Matrix multiply"sv, N * N * N, [&]() {
+        Matrix<double> c = a * b;
+        checksum += c(N / 2, N / 3);
+        });
+    const double nested_ms = MeasureMilliseconds("Vector<Vector<double>> multiply"sv, N * N * N, [&]() {
+        Vector<Vector<double>> c(N);
+        for (size_t i = 0; i < N; ++i)
+        {
+            c[i].Resize(N);
+            for (size_t k = 0; k < N; ++k)
+            {
+                for (size_t j = 0; j < N; ++j)
+                {
+                    c[i][j] += nested_a[i][k] * nested_b[k][j];
+                }
+            }
+        }
+        checksum += c[N / 2][N / 3];
+        });
+    const double transpose_ms = MeasureMilliseconds("Matrix transpose"sv, N * N, [&]() {
+        checksum += a.Transposed()(1, 2);
+        });
+    const double nested_transpose_ms = MeasureMilliseconds("Vector<Vector<double>> transpose"sv, N * N, [&]() {
+        Vector<Vector<double>> t(N);
+        for (size_t j = 0; j < N; ++j)
+        {
+            t[j].Resize(N);
+            for (size_t i = 0; i < N; ++i)
+            {
+                t[j][i] = nested_a[i][j];
+            }
+        }
+        checksum += t[1][2];
+        });
+    cerr << N << "x"sv << N << " matrices (checksum "sv << checksum << "):"sv << endl;
+    cerr << "Matrix: multiply "sv << matrix_ms << " ms, transpose "sv << transpose_ms
+        << " ms; Vector<Vector<double>>: multiply "sv << nested_ms << " ms, transpose "sv << nested_transpose_ms << " ms"sv << endl;
+}
+
+inline void BenchmarkBulkLoader()
+{
+    using namespace std;
+    const size_t NUM = 8'000'000;
+    const string path = (filesystem::temp_directory_path() / "vector_bulk_loader_bench.bin").string();
+    {
+        Vector<uint64_t> values(NUM);
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            values[i] = i * 2654435761u;
+        }
+        FILE* file = fopen(path.c_str(), "wb");
+        fwrite(values.begin(), sizeof(uint64_t), NUM, file);
+        fclose(file);
+    }
+    Vector<uint64_t> loaded;
+    LoadStats stats;
+    const double loader_ms = MeasureMilliseconds("LoadBinaryRecords"sv, NUM, [&]() {
+        stats = LoadBinaryRecords(path, loaded);
+        });
+    Vector<uint64_t> pushed;
+    const double push_ms = MeasureMilliseconds("ifstream + PushBack"sv, NUM, [&]() {
+        ifstream in(path, ios::binary);
+        vector<uint64_t> buffer(1 << 17);
+        while (in.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(uint64_t)) || in.gcount() > 0)
+        {
+            const size_t count = static_cast<size_t>(in.gcount()) / sizeof(uint64_t);
+            for (size_t i = 0; i < count; ++i)
+            {
+                pushed.PushBack(buffer[i]);
+            }
+        }
+        });
+    remove(path.c_str());
+    cerr << "Loading "sv << stats.bytes / (1 << 20) << " MiB of records (match "sv << (loaded[NUM - 1] == pushed[NUM - 1]) << "):"sv << endl;
+    cerr << "LoadBinaryRecords: "sv << loader_ms << " ms ("sv << stats.BytesPerSecond() / (1 << 20)
+        << " MiB/s), ifstream + PushBack: "sv << push_ms << " ms"sv << endl;
+}
+
+inline void BenchmarkShardedCollector()
+{
+    using namespace std;
+    const size_t THREADS = 8;
+    const size_t PER_THREAD = 500'000;
+    const auto run_producers = [&](auto produce) {
+        vector<thread> producers;
+        for (size_t t = 0; t < THREADS; ++t)
+        {
+            producers.emplace_back(produce, t);
+        }
+        for (thread& producer : producers)
+        {
+            producer.join();
+        }
+    };
+    Vector<uint64_t> locked;
+    mutex lock;
+    const double locked_ms = MeasureMilliseconds("locked PushBack"sv, THREADS * PER_THREAD, [&]() {
+        run_producers([&](size_t t) {
+            for (size_t i = 0; i < PER_THREAD; ++i)
+            {
+                lock_guard guard(lock);
+                locked.PushBack(t * PER_THREAD + i);
+            }
+            });
+        });
+    Vector<uint64_t> merged;
+    ShardedCollector<uint64_t> collector(THREADS);
+    double merge_ms = 0.0;
+    const double sharded_ms = MeasureMilliseconds("ShardedCollector"sv, THREADS * PER_THREAD, [&]() {
+        run_producers([&](size_t t) {
+            Vector<uint64_t>& shard = collector.Shard(t);
+            for (size_t i = 0; i < PER_THREAD; ++i)
+            {
+                shard.PushBack(t * PER_THREAD + i);
+            }
+            });
+        merge_ms = MeasureMilliseconds([&]() { collector.MergeInto(merged); });
+        });
+    cerr << THREADS << " producers x "sv << PER_THREAD << " items (sizes "sv << locked.Size() << "/"sv << merged.Size() << "):"sv << endl;
+    cerr << "Locked PushBack: "sv << locked_ms << " ms, ShardedCollector: "sv << sharded_ms
+        << " ms (merge "sv << merge_ms << " ms)"sv << endl;
+}
+
+// Pushes n pseudo-random keys and pops them all; returns nanoseconds per element.
+template <typename Heap, typename Push, typename Pop>
+double MeasureHeapRound(std::string_view variant, size_t n, uint64_t& checksum, Push push, Pop pop)
+{
+    const size_t rounds = std::max<size_t>(1, 1'000'000 / n);
+    const double ms = MeasureMilliseconds(variant, rounds * n, [&]() {
+        for (size_t round = 0; round < rounds; ++round)
+        {
+            Heap heap;
+            uint64_t key = round + 1;
+            for (size_t i = 0; i < n; ++i)
+            {
+                key = key * 6364136223846793005u + 1442695040888963407u;
+                push(heap, key >> 16);
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                checksum += pop(heap);
+            }
+        }
+        });
+    return ms * 1e6 / static_cast<double>(rounds * n);
+}
+
+inline void BenchmarkDaryHeap()
+{
+    using namespace std;
+    // 1e8 elements also works but needs several GB and minutes per run.
+    const size_t MAX_SIZE = 10'000'000;
+    uint64_t checksum = 0;
+    const auto dary_push = [](auto& heap, uint64_t key) { heap.Push(key); };
+    const auto dary_pop = [](auto& heap) { return heap.Pop(); };
+    for (size_t n = 1'000; n <= MAX_SIZE; n *= 10)
+    {
+        const double binary_ns = MeasureHeapRound<priority_queue<uint64_t>>("std::priority_queue"sv, n, checksum,
+            [](auto& heap, uint64_t key) { heap.push(key); },
+            [](auto& heap) { const uint64_t top = heap.top(); heap.pop(); return top; });
+        const double dary2_ns = MeasureHeapRound<DaryHeap<uint64_t, 2>>("DaryHeap<2>"sv, n, checksum, dary_push, dary_pop);
+        const double dary4_ns = MeasureHeapRound<DaryHeap<uint64_t, 4>>("DaryHeap<4>"sv, n, checksum, dary_push, dary_pop);
+        const double dary8_ns = MeasureHeapRound<DaryHeap<uint64_t, 8>>("DaryHeap<8>"sv, n, checksum, dary_push, dary_pop);
+        cerr << "Heap push+pop of "sv << n << " keys, ns per key: std::priority_queue "sv << binary_ns
+            << ", DaryHeap<2> "sv << dary2_ns << ", DaryHeap<4> "sv << dary4_ns << ", DaryHeap<8> "sv << dary8_ns << endl;
+    }
+    cerr << "Heap checksum "sv << checksum << endl;
+}
+
+inline void BenchmarkSearchIndex()
+{
+    using namespace std;
+    const size_t QUERIES = 2'000'000;
+    for (size_t n : { 1'000'000, 20'000'000 })
+    {
+        Vector<uint64_t> sorted(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            sorted[i] = i * 3;
+        }
+        Vector<uint64_t> keys(QUERIES);
+        uint64_t state = 12345;
+        for (size_t i = 0; i < QUERIES; ++i)
+        {
+            state = state * 6364136223846793005u + 1442695040888963407u;
+            keys[i] = (state >> 16) % (n * 3);
+        }
+        const SearchIndex<uint64_t> index(sorted);
+        size_t checksum = 0;
+        const double lower_bound_ms = MeasureMilliseconds("std::lower_bound"sv, QUERIES, [&]() {
+            for (uint64_t key : keys)
+            {
+                checksum += lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin();
+            }
+            });
+        const double single_ms = MeasureMilliseconds("SearchIndex::LowerBound"sv, QUERIES, [&]() {
+            for (uint64_t key : keys)
+            {
+                checksum += index.LowerBound(key);
+            }
+            });
+        Vector<size_t> positions;
+        const double batched_ms = MeasureMilliseconds("SearchIndex::LowerBoundMany"sv, QUERIES, [&]() {
+            index.LowerBoundMany(keys, positions);
+            });
+        checksum += positions[QUERIES / 2];
+        cerr << QUERIES << " searches in "sv << n << " keys (checksum "sv << checksum << "):"sv << endl;
+        cerr << "std::lower_bound: "sv << lower_bound_ms << " ms, SearchIndex::LowerBound: "sv << single_ms
+            << " ms, SearchIndex::LowerBoundMany: "sv << batched_ms << " ms"sv << endl;
+    }
+}
+
+// Resident set size in MiB, or 0 where /proc is not available.
+inline size_t ResidentMiB()
+{
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    if (!(statm >> total_pages >> resident_pages))
+    {
+        return 0;
+    }
+    return resident_pages * 4096 / (1 << 20);
+}
+
+inline void BenchmarkCapacityDecay()
+{
+    using namespace std;
+    const size_t SPIKE = 16'000'000;
+    const size_t STEADY = 1'000;
+    for (bool decay : { false, true })
+    {
+        Vector<uint64_t> v;
+        if (decay)
+        {
+            v.SetDecayPolicy({ 1'000, 25 });
+        }
+        const size_t before = ResidentMiB();
+        for (size_t i = 0; i < SPIKE; ++i)
+        {
+            v.PushBack(i);
+        }
+        const size_t peak = ResidentMiB();
+        const double drain_ms = MeasureMilliseconds(decay ? "drain with decay"sv : "drain without decay"sv, SPIKE - STEADY, [&]() {
+            while (v.Size() > STEADY)
+            {
+                v.PopBack();
+            }
+            });
+        cerr << (decay ? "With decay:    "sv : "Without decay: "sv) << "RSS "sv << before << " -> "sv << peak
+            << " -> "sv << ResidentMiB() << " MiB after draining to "sv << v.Size()
+            << " elements in "sv << drain_ms << " ms"sv << endl;
+    }
+}
+
+inline void BenchmarkDirtyTracking()
+{
+    using namespace std;
+    const size_t NUM = 20'000'000;
+    const size_t CHANGES = 1'000;
+    TrackedVector<uint64_t> source{ Vector<uint64_t>(NUM) };
+    Vector<uint64_t> replica;
+    ApplyPatches(replica, source.CollectDirty());
+    uint64_t state = 7;
+    for (size_t i = 0; i < CHANGES; ++i)
+    {
+        state = state * 6364136223846793005u + 1442695040888963407u;
+        source[(state >> 16) % NUM] = i;
+    }
+    size_t shipped = 0;
+    const double incremental_ms = MeasureMilliseconds("dirty patches"sv, CHANGES, [&]() {
+        const DirtySet<uint64_t> changes = source.CollectDirty();
+        shipped = changes.DirtyElements();
+        ApplyPatches(replica, changes);
+        });
+    Vector<uint64_t> full_copy;
+    const double full_ms = MeasureMilliseconds("full copy"sv, NUM, [&]() {
+        full_copy = source.Items();
+        });
+    cerr << CHANGES << " random writes into "sv << NUM << " elements (replica in sync "sv
+        << equal(replica.begin(), replica.end(), full_copy.begin(), full_copy.end()) << "):"sv << endl;
+    cerr << "Dirty patches: "sv << incremental_ms << " ms for "sv << shipped << " elements, full copy: "sv
+        << full_ms << " ms"sv << endl;
+}
+
+inline void BenchmarkGroupBy()
+{
+    using namespace std;
+    const size_t NUM = 20'000'000;
+    for (size_t distinct : { 1'000, 1'000'000 })
+    {
+        Vector<SortRecord> rows(NUM);
+        uint64_t state = 99;
+        for (size_t i = 0; i < NUM; ++i)
+        {
+            state = state * 6364136223846793005u + 1442695040888963407u;
+            rows[i] = SortRecord{ (state >> 20) % distinct, i & 0xff };
+        }
+        const auto key_of = [](const SortRecord& row) { return row.key; };
+        const auto payload_of = [](const SortRecord& row) { return row.payload; };
+        uint64_t map_total = 0;
+        const double map_ms = MeasureMilliseconds("std::unordered_map group-by"sv, NUM, [&]() {
+            unordered_map<uint64_t, uint64_t> sums;
+            for (const SortRecord& row : rows)
+            {
+                sums[row.key] += row.payload;
+            }
+            for (const auto& [key, sum] : sums)
+            {
+                map_total += sum;
+            }
+            });
+        uint64_t partitioned_total = 0;
+        const double partitioned_ms = MeasureMilliseconds("GroupBySum"sv, NUM, [&]() {
+            for (const auto& [key, sum] : GroupBySum(rows, key_of, payload_of))
+            {
+                partitioned_total += sum;
+            }
+            });
+        cerr << "Group-by sum of "sv << NUM << " rows over "sv << distinct << " keys (match "sv
+            << (map_total == partitioned_total) << "): std::unordered_map "sv << map_ms
+            << " ms, GroupBySum "sv << partitioned_ms << " ms on "sv << thread::hardware_concurrency() << " threads"sv << endl;
+    }
+}
+
+inline void BenchmarkDictVector()
+{
+    using namespace std;
+    const size_t NUM = 10'000'000;
+    const size_t DISTINCT = 200;
+    Vector<string> plain;
+    plain.Reserve(NUM);
+    DictVector<string> dict;
+    for (size_t i = 0; i < NUM; ++i)
+    {
+        plain.PushBack("customer-segment-"s + to_string(i * 2654435761u % DISTINCT));
+    }
+    const double build_ms = MeasureMilliseconds("DictVector build"sv, NUM, [&]() { dict.Append(plain.begin(), plain.end()); });
+
+    const string needle = "customer-segment-17"s;
+    size_t plain_matches = 0;
+    size_t dict_matches = 0;
+    const double plain_filter_ms = MeasureMilliseconds("Vector<std::string> filter"sv, NUM, [&]() {
+        plain_matches = static_cast<size_t>(count(plain.begin(), plain.end(), needle));
+        });
+    const double dict_filter_ms = MeasureMilliseconds("DictVector filter"sv, NUM, [&]() { dict_matches = dict.Count(needle); });
+    size_t largest_group = 0;
+    const double group_ms = MeasureMilliseconds("DictVector count by code"sv, NUM, [&]() {
+        const Vector<size_t> counts = dict.CountByCode();
+        largest_group = *max_element(counts.begin(), counts.end());
+        });
+
+    size_t heap_bytes = 0;
+    for (const string& s : plain)
+    {
+        heap_bytes += s.capacity() > 15 ? s.capacity() + 1 : 0;
+    }
+    cerr << "Dictionary column, "sv << NUM << " rows, "sv << DISTINCT << " distinct (match "sv
+        << (plain_matches == dict_matches) << ", largest group "sv << largest_group << "):"sv << endl;
+    cerr << "Vector<std::string>: "sv << (plain.MemoryFootprint().reserved_bytes + heap_bytes) / (1 << 20)
+        << " MiB, equality filter "sv << plain_filter_ms << " ms"sv << endl;
+    cerr << "DictVector: "sv << dict.MemoryFootprint().reserved_bytes / (1 << 20) << " MiB, "sv
+        << dict.CodeWidth() << "-byte codes, equality filter "sv << dict_filter_ms << " ms, count by code "sv
+        << group_ms << " ms, build "sv << build_ms << " ms"sv << endl;
+
+    // Every value new: the dictionary grows with the column.
+    const size_t HIGH_DISTINCT = 1'000'000;
+    DictVector<string> high;
+    const double high_build_ms = MeasureMilliseconds("DictVector distinct build"sv, HIGH_DISTINCT, [&]() {
+        for (size_t i = 0; i < HIGH_DISTINCT; ++i)
+        {
+            high.PushBack("customer-"s + to_string(i));
+        }
+        });
+    // Strided integer ids, whose std::hash is the identity.
+    DictVector<uint64_t> ids;
+    const double ids_build_ms = MeasureMilliseconds("DictVector strided ids build"sv, HIGH_DISTINCT, [&]() {
+        for (size_t i = 0; i < HIGH_DISTINCT; ++i)
+        {
+            ids.PushBack(i * 4096);
+        }
+        });
+    cerr << "DictVector of "sv << HIGH_DISTINCT << " distinct values: build "sv << high_build_ms << " ms, "sv
+        << high.CodeWidth() << "-byte codes; "sv << ids.DictionarySize() << " ids with stride 4096: build "sv
+        << ids_build_ms << " ms"sv << endl;
+}
+
+inline void BenchmarkParallelConstruct()
+{
+    using namespace std;
+    const size_t NUM = 16'000'000;
+    const size_t threads = max<size_t>(thread::hardware_concurrency(), 1);
+    // Sums the vector in the same slices the parallel builders touch first.
+    const auto parallel_scan_ms = [threads](const Vector<uint64_t>& values, uint64_t& checksum) {
+        Vector<uint64_t> sums(threads);
+        const double ms = MeasureMilliseconds("parallel scan"sv, values.Size(), [&]() {
+            vector<thread> workers;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t]() {
+                    const size_t first = values.Size() * t / threads;
+                    const size_t last = values.Size() * (t + 1) / threads;
+                    sums[t] = accumulate(values.begin() + first, values.begin() + last, uint64_t{ 0 });
+                    });
+            }
+            for (thread& worker : workers)
+            {
+                worker.join();
+            }
+            });
+        checksum += accumulate(sums.begin(), sums.end(), uint64_t{ 0 });
+        return ms;
+    };
+    const auto print_nodes = [](const Vector<uint64_t>& values) {
+        const Vector<size_t> nodes = PagesPerNode(values.Data(), values.Size() * sizeof(uint64_t));
+        if (nodes.Size() == 0)
+        {
+            cerr << "page placement unavailable"sv;
+        }
+        for (size_t node = 0; node < nodes.Size(); ++node)
+        {
+            cerr << (node == 0 ? "pages per node: "sv : ", "sv) << node << ":"sv << nodes[node];
+        }
+    };
+
+    uint64_t checksum = 0;
+    {
+        Vector<uint64_t> serial;
+        const double build_ms = MeasureMilliseconds("Vector(size)"sv, NUM, [&]() { Vector<uint64_t>(NUM).Swap(serial); });
+        Vector<uint64_t> serial_copy;
+        const double copy_ms = MeasureMilliseconds("Vector copy"sv, NUM, [&]() { Vector<uint64_t>(serial).Swap(serial_copy); });
+        cerr << "Vector(size) of "sv << NUM << " uint64_t: build "sv << build_ms << " ms, copy "sv << copy_ms
+            << " ms, parallel scan "sv << parallel_scan_ms(serial, checksum) << " ms, "sv;
+        print_nodes(serial);
+        cerr << endl;
+    }
+    for (const PagePlacement placement : { PagePlacement::kFirstTouch, PagePlacement::kInterleave })
+    {
+        ParallelInit options;
+        options.placement = placement;
+        Vector<uint64_t> parallel;
+        const double build_ms = MeasureMilliseconds("MakeVectorParallel"sv, NUM, [&]() { MakeVectorParallel<uint64_t>(NUM, options).Swap(parallel); });
+        Vector<uint64_t> parallel_copy;
+        const double copy_ms = MeasureMilliseconds("CopyParallel"sv, NUM, [&]() { CopyParallel(parallel, options).Swap(parallel_copy); });
+        cerr << (placement == PagePlacement::kFirstTouch ? "MakeVectorParallel, first touch: "sv : "MakeVectorParallel, interleaved: "sv)
+            << "build "sv << build_ms << " ms, copy "sv << copy_ms << " ms, parallel scan "sv
+            << parallel_scan_ms(parallel, checksum) << " ms, "sv;
+        print_nodes(parallel);
+        cerr << endl;
+    }
+
+    const size_t STRINGS = 2'000'000;
+    Vector<string> strings(STRINGS);
+    for (string& s : strings)
+    {
+        s.assign(40, 'x');
+    }
+    Vector<string> strings_copy = CopyParallel(strings);
+    const double serial_destroy_ms = MeasureMilliseconds("serial destroy"sv, STRINGS, [&]() { strings.ClearAndTrim(); });
+    const double parallel_destroy_ms = MeasureMilliseconds("DestroyParallel"sv, STRINGS, [&]() { DestroyParallel(strings_copy); });
+    cerr << "Destroying "sv << STRINGS << " heap strings: serial "sv << serial_destroy_ms << " ms, DestroyParallel "sv
+        << parallel_destroy_ms << " ms on "sv << threads << " threads (checksum "sv << checksum << ")"sv << endl;
+}
+
+inline void BenchmarkTraceReplay()
+{
+    using namespace std;
+    struct Record
+    {
+        uint64_t key;
+        uint64_t payload[2];
+    };
+    const size_t VECTORS = 2'000;
+    const size_t STEPS = 2'000'000;
+    // Per-connection buffers: mostly appends, occasional erases, periodic drains.
+    const auto workload = [&](TraceRecorder* recorder) {
+        Vector<Vector<Record>> buffers(VECTORS);
+        for (Vector<Record>& buffer : buffers)
+        {
+            buffer.SetTraceRecorder(recorder);
+        }
+        uint64_t state = 88172645463325252u;
+        for (size_t step = 0; step < STEPS; ++step)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            Vector<Record>& buffer = buffers[state % VECTORS];
+            const uint64_t action = (state >> 32) % 100;
+            if (action < 90 || buffer.Size() == 0)
+            {
+                buffer.PushBack(Record{ state, { step, step } });
+            }
+            else if (action < 97)
+            {
+                buffer.Erase(buffer.begin() + (state >> 40) % buffer.Size());
+            }
+            else
+            {
+                buffer.Clear();
+            }
+        }
+    };
+
+    const double plain_ms = MeasureMilliseconds("untraced workload"sv, STEPS, [&]() { workload(nullptr); });
+    TraceRecorder recorder;
+    const double traced_ms = MeasureMilliseconds("traced workload"sv, STEPS, [&]() { workload(&recorder); });
+    const Vector<TraceEvent> events = DecodeTrace(recorder.Bytes());
+    cerr << "Trace of "sv << events.Size() << " events, "sv << recorder.Bytes().size() << " bytes; workload "sv
+        << plain_ms << " ms untraced, "sv << traced_ms << " ms traced"sv << endl;
+    CompareReplays(cerr, events);
+}
+
+inline void BenchmarksForVector()
+{
+    BenchmarkIncrementalGrowth();
+    BenchmarkQueues();
+    BenchmarkStringVector();
+    BenchmarkViews();
+    BenchmarkExpressions();
+    BenchmarkSorts();
+    BenchmarkIndexedVector();
+    BenchmarkStaticVector();
+    BenchmarkMatrix();
+    BenchmarkBulkLoader();
+    BenchmarkShardedCollector();
+    BenchmarkDaryHeap();
+    BenchmarkSearchIndex();
+    BenchmarkCapacityDecay();
+    BenchmarkDirtyTracking();
+    BenchmarkGroupBy();
+    BenchmarkDictVector();
+    BenchmarkParallelConstruct();
+    BenchmarkTraceReplay();
+}
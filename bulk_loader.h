@@ -0,0 +1,345 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BULK_LOADER_POSIX 1
+#endif
+
+#include "vector.h"
+
+struct LoadStats
+{
+    size_t bytes = 0;
+    size_t records = 0;
+    double seconds = 0.0;
+
+    double BytesPerSecond() const noexcept
+    {
+        return seconds > 0.0 ? static_cast<double>(bytes) / seconds : 0.0;
+    }
+};
+
+inline constexpr size_t kDefaultLoadChunkBytes = size_t(1) << 20;
+
+namespace bulk_loader_detail
+{
+    // Read-only file with positional reads; pread on POSIX, stdio elsewhere.
+    class InputFile
+    {
+    public:
+        explicit InputFile(const std::string& path);
+
+        InputFile(const InputFile&) = delete;
+        InputFile& operator=(const InputFile&) = delete;
+
+        ~InputFile() noexcept;
+
+        size_t Size() const noexcept;
+
+        // Reads up to count bytes at offset; returns fewer only at end of file.
+        size_t ReadAt(void* buffer, size_t count, size_t offset);
+
+    private:
+        [[noreturn]] void Fail(const char* what) const;
+
+        std::string path_;
+        size_t size_ = 0;
+#ifdef BULK_LOADER_POSIX
+        int fd_ = -1;
+#else
+        std::FILE* file_ = nullptr;
+#endif
+    };
+
+    inline InputFile::InputFile(const std::string& path)
+        : path_(path)
+    {
+#ifdef BULK_LOADER_POSIX
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+        {
+            Fail("open");
+        }
+        struct stat info;
+        if (::fstat(fd_, &info) != 0)
+        {
+            const int error = errno;
+            ::close(fd_);
+            errno = error;
+            Fail("fstat");
+        }
+        size_ = static_cast<size_t>(info.st_size);
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#else
+        file_ = std::fopen(path.c_str(), "rb");
+        if (file_ == nullptr || std::fseek(file_, 0, SEEK_END) != 0)
+        {
+            Fail("open");
+        }
+        size_ = static_cast<size_t>(std::ftell(file_));
+#endif
+    }
+
+    inline InputFile::~InputFile() noexcept
+    {
+#ifdef BULK_LOADER_POSIX
+        ::close(fd_);
+#else
+        std::fclose(file_);
+#endif
+    }
+
+    inline size_t InputFile::Size() const noexcept
+    {
+        return size_;
+    }
+
+    inline size_t InputFile::ReadAt(void* buffer, size_t count, size_t offset)
+    {
+        char* dest = static_cast<char*>(buffer);
+        size_t done = 0;
+        while (done < count)
+        {
+#ifdef BULK_LOADER_POSIX
+            const ssize_t got = ::pread(fd_, dest + done, count - done, static_cast<off_t>(offset + done));
+            if (got < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                Fail("pread");
+            }
+#else
+            if (std::fseek(file_, static_cast<long>(offset + done), SEEK_SET) != 0)
+            {
+                Fail("fseek");
+            }
+            const size_t got = std::fread(dest + done, 1, count - done, file_);
+            if (got == 0 && std::ferror(file_))
+            {
+                Fail("fread");
+            }
+#endif
+            if (got == 0)
+            {
+                break;
+            }
+            done += static_cast<size_t>(got);
+        }
+        return done;
+    }
+
+    inline void InputFile::Fail(const char* what) const
+    {
+        throw std::runtime_error(std::string(what) + " failed for " + path_ + ": " + std::strerror(errno));
+    }
+
+    inline double SecondsSince(std::chrono::steady_clock::time_point start) noexcept
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+// Appends the fixed-size records stored in path, starting at byte offset, to
+// out. Capacity for the whole file is reserved once and every chunk is read
+// straight into the vector's uninitialized tail.
+template <typename T>
+LoadStats LoadBinaryRecords(const std::string& path, Vector<T>& out, size_t offset = 0,
+    size_t chunk_bytes = kDefaultLoadChunkBytes)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "binary records must be trivially copyable");
+    const auto start = std::chrono::steady_clock::now();
+    bulk_loader_detail::InputFile file(path);
+    const size_t available = file.Size() > offset ? file.Size() - offset : 0;
+    if (available % sizeof(T) != 0)
+    {
+        throw std::runtime_error(path + " does not hold a whole number of records");
+    }
+    const size_t total = available / sizeof(T);
+    const size_t per_chunk = std::max<size_t>(1, chunk_bytes / sizeof(T));
+    out.Reserve(out.Size() + total);
+
+    LoadStats stats;
+    while (stats.records < total)
+    {
+        const size_t want = std::min(per_chunk, total - stats.records);
+        const size_t position = offset + stats.records * sizeof(T);
+        const size_t got = out.AppendInPlace(want, [&](T* dest, size_t count) {
+            const size_t bytes = file.ReadAt(dest, count * sizeof(T), position);
+            if (bytes != count * sizeof(T))
+            {
+                throw std::runtime_error(path + " was truncated while loading");
+            }
+            return count;
+            });
+        stats.records += got;
+    }
+    stats.bytes = total * sizeof(T);
+    stats.seconds = bulk_loader_detail::SecondsSince(start);
+    return stats;
+}
+
+// Appends one record per line of path to out, using parse(std::string_view)
+// to build each T. A background thread keeps the next chunk in flight while
+// the current one is parsed, so I/O and parsing overlap. Capacity is reserved
+// ahead from the line density of the first chunk.
+template <typename T, typename Parse>
+LoadStats LoadTextRecords(const std::string& path, Vector<T>& out, Parse parse,
+    size_t chunk_bytes = kDefaultLoadChunkBytes)
+{
+    const auto start = std::chrono::steady_clock::now();
+    bulk_loader_detail::InputFile file(path);
+    const size_t file_size = file.Size();
+
+    struct Chunk
+    {
+        Vector<char> bytes;
+        size_t size = 0;
+        bool ready = false;
+    };
+    Chunk chunks[2];
+    chunks[0].bytes.Resize(chunk_bytes);
+    chunks[1].bytes.Resize(chunk_bytes);
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool stop = false;
+    std::exception_ptr read_error;
+
+    std::thread reader([&]() {
+        size_t offset = 0;
+        for (size_t turn = 0; offset < file_size; ++turn)
+        {
+            Chunk& chunk = chunks[turn % 2];
+            {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&]() { return stop || !chunk.ready; });
+                if (stop)
+                {
+                    return;
+                }
+            }
+            size_t got = 0;
+            try
+            {
+                got = file.ReadAt(chunk.bytes.begin(), chunk_bytes, offset);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(mutex);
+                read_error = std::current_exception();
+                chunk.size = 0;
+                chunk.ready = true;
+                changed.notify_all();
+                return;
+            }
+            offset += got;
+            {
+                std::lock_guard lock(mutex);
+                chunk.size = got;
+                chunk.ready = true;
+            }
+            changed.notify_all();
+            if (got == 0)
+            {
+                return;
+            }
+        }
+        });
+
+    const auto stop_reader = [&]() {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+        changed.notify_all();
+        reader.join();
+    };
+
+    LoadStats stats;
+    std::string carry;
+    const auto emit = [&](std::string_view line) {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        if (!line.empty())
+        {
+            out.EmplaceBack(parse(line));
+            ++stats.records;
+        }
+    };
+    try
+    {
+        for (size_t turn = 0; stats.bytes < file_size; ++turn)
+        {
+            Chunk& chunk = chunks[turn % 2];
+            {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&]() { return chunk.ready; });
+                if (read_error)
+                {
+                    std::rethrow_exception(read_error);
+                }
+            }
+            if (chunk.size == 0)
+            {
+                break;
+            }
+            const std::string_view text(chunk.bytes.begin(), chunk.size);
+            if (turn == 0)
+            {
+                const size_t lines = std::count(text.begin(), text.end(), '\n') + 1;
+                out.Reserve(out.Size() + file_size * lines / text.size() + lines);
+            }
+            size_t line_start = 0;
+            for (size_t newline = text.find('\n'); newline != std::string_view::npos; newline = text.find('\n', line_start))
+            {
+                if (carry.empty())
+                {
+                    emit(text.substr(line_start, newline - line_start));
+                }
+                else
+                {
+                    carry.append(text.substr(line_start, newline - line_start));
+                    emit(carry);
+                    carry.clear();
+                }
+                line_start = newline + 1;
+            }
+            carry.append(text.substr(line_start));
+            stats.bytes += chunk.size;
+            {
+                std::lock_guard lock(mutex);
+                chunk.ready = false;
+            }
+            changed.notify_all();
+        }
+        emit(carry);
+    }
+    catch (...)
+    {
+        stop_reader();
+        throw;
+    }
+    stop_reader();
+    stats.seconds = bulk_loader_detail::SecondsSince(start);
+    return stats;
+}
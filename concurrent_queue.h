@@ -0,0 +1,409 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "vector.h"
+
+inline constexpr size_t kCacheLineSize = 64;
+
+inline size_t RoundUpToPowerOfTwo(size_t value) noexcept
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Bounded single-producer single-consumer ring. Each side keeps a private copy
+// of the other side's index and reloads the shared atomic only when the copy
+// says the ring is full (producer) or empty (consumer).
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity);
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue() noexcept;
+
+    bool TryPush(const T& value);
+    bool TryPush(T&& value);
+
+    template<typename ... Args>
+    bool TryEmplace(Args&&... args);
+
+    bool TryPop(T& out);
+
+    // Moves elements from [first, last) until the ring is full; returns how many were pushed.
+    template <typename It>
+    size_t TryPushBatch(It first, It last);
+
+    // Appends up to max_count elements to out; returns how many were popped.
+    size_t TryPopBatch(Vector<T>& out, size_t max_count);
+
+    size_t Capacity() const noexcept;
+
+private:
+    RawMemory<T> slots_;
+    const size_t mask_;
+
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{ 0 };
+    size_t cached_head_ = 0;
+
+    alignas(kCacheLineSize) std::atomic<size_t> head_{ 0 };
+    size_t cached_tail_ = 0;
+};
+
+// Bounded multi-producer multi-consumer queue with a sequence number per slot
+// (D. Vyukov's design). A slot is writable when its sequence equals the
+// producer's ticket and readable when it equals the ticket plus one.
+template <typename T>
+class MpmcQueue
+{
+public:
+    explicit MpmcQueue(size_t capacity);
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue() noexcept;
+
+    bool TryPush(const T& value);
+    bool TryPush(T&& value);
+
+    template<typename ... Args>
+    bool TryEmplace(Args&&... args);
+
+    bool TryPop(T& out);
+
+    // Claims the longest run of free slots, up to the length of [first, last),
+    // with a single CAS and moves that many elements in; returns how many.
+    // It must be a forward iterator.
+    template <typename It>
+    size_t TryPushBatch(It first, It last);
+
+    // Claims up to max_count ready elements with a single CAS and appends them to out.
+    size_t TryPopBatch(Vector<T>& out, size_t max_count);
+
+    size_t Capacity() const noexcept;
+
+private:
+    // Length of the run of slots from ticket pos, at most max_count, whose
+    // sequence is the ticket plus offset (0 for writable, 1 for readable).
+    size_t RunLength(size_t pos, size_t offset, size_t max_count) const noexcept;
+
+    RawMemory<T> slots_;
+    RawMemory<std::atomic<size_t>> sequences_;
+    const size_t mask_;
+
+    alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_{ 0 };
+    alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_{ 0 };
+};
+
+//---------------------------------------SpscQueue-----------------------------
+
+template<typename T>
+inline SpscQueue<T>::SpscQueue(size_t capacity)
+    : slots_(RoundUpToPowerOfTwo(capacity))
+    , mask_(slots_.Capacity() - 1)
+{}
+
+template<typename T>
+inline SpscQueue<T>::~SpscQueue() noexcept
+{
+    for (size_t i = head_.load(std::memory_order_relaxed); i != tail_.load(std::memory_order_relaxed); ++i)
+    {
+        std::destroy_at(slots_ + (i & mask_));
+    }
+}
+
+template<typename T>
+inline bool SpscQueue<T>::TryPush(const T& value)
+{
+    return TryEmplace(value);
+}
+
+template<typename T>
+inline bool SpscQueue<T>::TryPush(T&& value)
+{
+    return TryEmplace(std::move(value));
+}
+
+template<typename T>
+template<typename ...Args>
+inline bool SpscQueue<T>::TryEmplace(Args && ...args)
+{
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == slots_.Capacity())
+    {
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (tail - cached_head_ == slots_.Capacity())
+        {
+            return false;
+        }
+    }
+    new(slots_ + (tail & mask_)) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+inline bool SpscQueue<T>::TryPop(T& out)
+{
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_)
+    {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head == cached_tail_)
+        {
+            return false;
+        }
+    }
+    T* slot = slots_ + (head & mask_);
+    out = std::move(*slot);
+    std::destroy_at(slot);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+template<typename It>
+inline size_t SpscQueue<T>::TryPushBatch(It first, It last)
+{
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    cached_head_ = head_.load(std::memory_order_acquire);
+    const size_t free_slots = slots_.Capacity() - (tail - cached_head_);
+    size_t count = 0;
+    for (; first != last && count < free_slots; ++first, ++count)
+    {
+        new(slots_ + ((tail + count) & mask_)) T(std::move(*first));
+    }
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+template<typename T>
+inline size_t SpscQueue<T>::TryPopBatch(Vector<T>& out, size_t max_count)
+{
+    const size_t head = head_.load(std::memory_order_relaxed);
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    const size_t count = std::min(max_count, cached_tail_ - head);
+    // Doubled like PushBack would, so a consumer that keeps appending stays linear.
+    if (out.Capacity() < out.Size() + count)
+    {
+        out.Reserve(std::max(out.Size() + count, out.Capacity() * 2));
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        T* slot = slots_ + ((head + i) & mask_);
+        out.PushBack(std::move(*slot));
+        std::destroy_at(slot);
+    }
+    head_.store(head + count, std::memory_order_release);
+    return count;
+}
+
+template<typename T>
+inline size_t SpscQueue<T>::Capacity() const noexcept
+{
+    return slots_.Capacity();
+}
+
+//---------------------------------------MpmcQueue-----------------------------
+
+template<typename T>
+inline MpmcQueue<T>::MpmcQueue(size_t capacity)
+    : slots_(RoundUpToPowerOfTwo(capacity))
+    , sequences_(slots_.Capacity())
+    , mask_(slots_.Capacity() - 1)
+{
+    for (size_t i = 0; i < sequences_.Capacity(); ++i)
+    {
+        new(sequences_ + i) std::atomic<size_t>(i);
+    }
+}
+
+template<typename T>
+inline MpmcQueue<T>::~MpmcQueue() noexcept
+{
+    for (size_t i = dequeue_pos_.load(std::memory_order_relaxed); i != enqueue_pos_.load(std::memory_order_relaxed); ++i)
+    {
+        std::destroy_at(slots_ + (i & mask_));
+    }
+    std::destroy_n(sequences_.GetAddress(), sequences_.Capacity());
+}
+
+template<typename T>
+inline bool MpmcQueue<T>::TryPush(const T& value)
+{
+    return TryEmplace(value);
+}
+
+template<typename T>
+inline bool MpmcQueue<T>::TryPush(T&& value)
+{
+    return TryEmplace(std::move(value));
+}
+
+template<typename T>
+template<typename ...Args>
+inline bool MpmcQueue<T>::TryEmplace(Args && ...args)
+{
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        const size_t seq = sequences_[pos & mask_].load(std::memory_order_acquire);
+        const ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+        if (diff == 0)
+        {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    new(slots_ + (pos & mask_)) T(std::forward<Args>(args)...);
+    sequences_[pos & mask_].store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+inline bool MpmcQueue<T>::TryPop(T& out)
+{
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        const size_t seq = sequences_[pos & mask_].load(std::memory_order_acquire);
+        const ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + 1);
+        if (diff == 0)
+        {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    T* slot = slots_ + (pos & mask_);
+    out = std::move(*slot);
+    std::destroy_at(slot);
+    sequences_[pos & mask_].store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T>
+template<typename It>
+inline size_t MpmcQueue<T>::TryPushBatch(It first, It last)
+{
+    const size_t wanted = static_cast<size_t>(std::distance(first, last));
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    size_t count = 0;
+    while (wanted != 0)
+    {
+        count = RunLength(pos, 0, wanted);
+        if (count != 0)
+        {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (static_cast<ptrdiff_t>(sequences_[pos & mask_].load(std::memory_order_acquire) - pos) < 0)
+        {
+            return 0;
+        }
+        else
+        {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    for (size_t i = 0; i < count; ++i, ++first)
+    {
+        new(slots_ + ((pos + i) & mask_)) T(std::move(*first));
+        sequences_[(pos + i) & mask_].store(pos + i + 1, std::memory_order_release);
+    }
+    return count;
+}
+
+template<typename T>
+inline size_t MpmcQueue<T>::TryPopBatch(Vector<T>& out, size_t max_count)
+{
+    max_count = std::min(max_count, slots_.Capacity());
+    // Reserved before claiming, so that the claimed slots are always released;
+    // doubled, so a consumer that keeps appending stays linear.
+    if (out.Capacity() < out.Size() + max_count)
+    {
+        out.Reserve(std::max(out.Size() + max_count, out.Capacity() * 2));
+    }
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    size_t count = 0;
+    while (max_count != 0)
+    {
+        count = RunLength(pos, 1, max_count);
+        if (count != 0)
+        {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (static_cast<ptrdiff_t>(sequences_[pos & mask_].load(std::memory_order_acquire) - (pos + 1)) < 0)
+        {
+            return 0;
+        }
+        else
+        {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        T* slot = slots_ + ((pos + i) & mask_);
+        out.PushBack(std::move(*slot));
+        std::destroy_at(slot);
+        sequences_[(pos + i) & mask_].store(pos + i + mask_ + 1, std::memory_order_release);
+    }
+    return count;
+}
+
+template<typename T>
+inline size_t MpmcQueue<T>::Capacity() const noexcept
+{
+    return slots_.Capacity();
+}
+
+template<typename T>
+inline size_t MpmcQueue<T>::RunLength(size_t pos, size_t offset, size_t max_count) const noexcept
+{
+    max_count = std::min(max_count, slots_.Capacity());
+    size_t count = 0;
+    while (count < max_count && sequences_[(pos + count) & mask_].load(std::memory_order_acquire) == pos + count + offset)
+    {
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "memory_footprint.h"
+#include "vector.h"
+
+// Opt-in process-wide list of tagged containers. A container is registered
+// explicitly and stays listed while the returned Registration is alive; the
+// container must not be moved or destroyed before its Registration.
+class ContainerRegistry
+{
+public:
+    struct Entry
+    {
+        std::string tag;
+        Footprint footprint;
+    };
+
+    struct Snapshot
+    {
+        Vector<Entry> largest;
+        Footprint total;
+        size_t containers = 0;
+    };
+
+    class Registration
+    {
+    public:
+        Registration() = default;
+        Registration(ContainerRegistry* registry, size_t id) noexcept;
+
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+        Registration(Registration&& other) noexcept;
+        Registration& operator=(Registration&& rhs) noexcept;
+
+        ~Registration();
+
+        void Reset() noexcept;
+
+    private:
+        ContainerRegistry* registry_ = nullptr;
+        size_t id_ = 0;
+    };
+
+    static ContainerRegistry& Instance();
+
+    template <typename Container>
+    [[nodiscard]] Registration Register(std::string tag, const Container& container);
+
+    // Walks every registered container, so call it while they are not being modified.
+    Snapshot TakeSnapshot(size_t top_n) const;
+
+    size_t Count() const;
+
+private:
+    struct Record
+    {
+        std::string tag;
+        std::function<Footprint()> measure;
+    };
+
+    void Unregister(size_t id) noexcept;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<size_t, Record> records_;
+    size_t next_id_ = 1;
+};
+
+//------------Registration----------------
+
+inline ContainerRegistry::Registration::Registration(ContainerRegistry* registry, size_t id) noexcept
+    : registry_(registry)
+    , id_(id)
+{}
+
+inline ContainerRegistry::Registration::Registration(Registration&& other) noexcept
+{
+    std::swap(registry_, other.registry_);
+    std::swap(id_, other.id_);
+}
+
+inline ContainerRegistry::Registration& ContainerRegistry::Registration::operator=(Registration&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        Reset();
+        std::swap(registry_, rhs.registry_);
+        std::swap(id_, rhs.id_);
+    }
+    return *this;
+}
+
+inline ContainerRegistry::Registration::~Registration()
+{
+    Reset();
+}
+
+inline void ContainerRegistry::Registration::Reset() noexcept
+{
+    if (registry_ != nullptr)
+    {
+        registry_->Unregister(id_);
+        registry_ = nullptr;
+        id_ = 0;
+    }
+}
+
+//------------ContainerRegistry----------------
+
+inline ContainerRegistry& ContainerRegistry::Instance()
+{
+    static ContainerRegistry registry;
+    return registry;
+}
+
+template<typename Container>
+inline ContainerRegistry::Registration ContainerRegistry::Register(std::string tag, const Container& container)
+{
+    const Container* address = &container;
+    std::lock_guard lock(mutex_);
+    size_t id = next_id_++;
+    records_.emplace(id, Record{ std::move(tag), [address]() { return address->MemoryFootprint(); } });
+    return Registration(this, id);
+}
+
+inline ContainerRegistry::Snapshot ContainerRegistry::TakeSnapshot(size_t top_n) const
+{
+    Snapshot result;
+    {
+        std::lock_guard lock(mutex_);
+        result.largest.Reserve(records_.size());
+        for (const auto& [id, record] : records_)
+        {
+            Footprint footprint = record.measure();
+            result.total += footprint;
+            result.largest.PushBack(Entry{ record.tag, footprint });
+        }
+    }
+    result.containers = result.largest.Size();
+    std::sort(result.largest.begin(), result.largest.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.footprint.reserved_bytes > rhs.footprint.reserved_bytes;
+        });
+    result.largest.Resize(std::min(top_n, result.largest.Size()));
+    return result;
+}
+
+inline size_t ContainerRegistry::Count() const
+{
+    std::lock_guard lock(mutex_);
+    return records_.size();
+}
+
+inline void ContainerRegistry::Unregister(size_t id) noexcept
+{
+    std::lock_guard lock(mutex_);
+    records_.erase(id);
+}
@@ -0,0 +1,420 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "vector.h"
+
+// Implicit d-ary heap in a Vector. With the default std::less the largest
+// element is on top, as in std::priority_queue. D = 4 or 8 keeps all children
+// of a node within one cache line for small T, and halves or thirds the depth.
+//
+// With TrackPositions every element gets a stable Handle on insertion, and a
+// handle -> index map allows DecreaseKey in O(log n).
+template <typename T, size_t D = 4, typename Compare = std::less<T>, bool TrackPositions = false>
+class DaryHeap
+{
+    static_assert(D >= 2, "a heap needs at least two children per node");
+
+public:
+    using Handle = size_t;
+    static constexpr Handle kNoHandle = std::numeric_limits<Handle>::max();
+
+    DaryHeap() = default;
+    explicit DaryHeap(Compare compare);
+
+    size_t Size() const noexcept;
+    bool Empty() const noexcept;
+
+    void Reserve(size_t capacity);
+    void Clear() noexcept;
+
+    // Replaces the contents with values in O(n). With TrackPositions, values[i]
+    // gets handle i.
+    void Heapify(Vector<T> values);
+
+    // Returns the new element's handle, or kNoHandle without TrackPositions.
+    Handle Push(const T& value);
+    Handle Push(T&& value);
+
+    // Appends a range; large batches are absorbed with one bottom-up heapify
+    // instead of sifting each element. Handles are appended to *handles if given.
+    template <typename InputIt>
+    void PushBatch(InputIt first, InputIt last, Vector<Handle>* handles = nullptr);
+
+    const T& Top() const noexcept;
+    T Pop();
+
+    // Valid only with TrackPositions, for handles still in the heap.
+    const T& Get(Handle handle) const noexcept;
+
+    // Gives the element a value that ranks no lower than the current one
+    // (smaller for a min-heap built with std::greater) and restores heap order.
+    void DecreaseKey(Handle handle, T value);
+
+private:
+    Handle AcquireHandle(size_t index);
+    void Place(size_t index, T&& value, Handle handle) noexcept;
+    size_t BestChild(size_t first, size_t size) const;
+    void SiftUp(size_t index);
+    void SiftDown(size_t index);
+    void Rebuild();
+
+    Vector<T> items_;
+    Vector<Handle> handles_;       // index -> handle
+    Vector<size_t> positions_;     // handle -> index
+    Vector<Handle> free_handles_;
+    Compare compare_;
+};
+
+//----------------------------DaryHeap------------------------------------------------
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline DaryHeap<T, D, Compare, TrackPositions>::DaryHeap(Compare compare)
+    : compare_(std::move(compare))
+{}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline size_t DaryHeap<T, D, Compare, TrackPositions>::Size() const noexcept
+{
+    return items_.Size();
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline bool DaryHeap<T, D, Compare, TrackPositions>::Empty() const noexcept
+{
+    return items_.Size() == 0;
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline void DaryHeap<T, D, Compare, TrackPositions>::Reserve(size_t capacity)
+{
+    items_.Reserve(capacity);
+    if constexpr (TrackPositions)
+    {
+        handles_.Reserve(capacity);
+        positions_.Reserve(capacity);
+    }
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline void DaryHeap<T, D, Compare, TrackPositions>::Clear() noexcept
+{
+    items_.Clear();
+    handles_.Clear();
+    positions_.Clear();
+    free_handles_.Clear();
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline void DaryHeap<T, D, Compare, TrackPositions>::Heapify(Vector<T> values)
+{
+    Clear();
+    items_.Swap(values);
+    if constexpr (TrackPositions)
+    {
+        handles_.Resize(items_.Size());
+        positions_.Resize(items_.Size());
+        for (size_t i = 0; i < items_.Size(); ++i)
+        {
+            handles_[i] = i;
+            positions_[i] = i;
+        }
+    }
+    Rebuild();
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline typename DaryHeap<T, D, Compare, TrackPositions>::Handle DaryHeap<T, D, Compare, TrackPositions>::Push(const T& value)
+{
+    return Push(T(value));
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline typename DaryHeap<T, D, Compare, TrackPositions>::Handle DaryHeap<T, D, Compare, TrackPositions>::Push(T&& value)
+{
+    const size_t index = items_.Size();
+    items_.PushBack(std::move(value));
+    Handle handle;
+    try
+    {
+        handle = AcquireHandle(index);
+    }
+    catch (...)
+    {
+        items_.PopBack();
+        throw;
+    }
+    SiftUp(index);
+    return handle;
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+template<typename InputIt>
+inline void DaryHeap<T, D, Compare, TrackPositions>::PushBatch(InputIt first, InputIt last, Vector<Handle>* handles)
+{
+    const size_t old_size = items_.Size();
+    try
+    {
+        for (; first != last; ++first)
+        {
+            items_.PushBack(*first);
+            Handle handle;
+            try
+            {
+                handle = AcquireHandle(items_.Size() - 1);
+            }
+            catch (...)
+            {
+                items_.PopBack();
+                throw;
+            }
+            if (handles != nullptr)
+            {
+                handles->PushBack(handle);
+            }
+        }
+    }
+    catch (...)
+    {
+        // Keep what was added so far, but in heap order.
+        Rebuild();
+        throw;
+    }
+    const size_t added = items_.Size() - old_size;
+    // Sifting each new leaf costs about log_D(n) moves apiece; a rebuild costs O(n).
+    if (added > old_size / 4)
+    {
+        Rebuild();
+    }
+    else
+    {
+        for (size_t i = old_size; i < items_.Size(); ++i)
+        {
+            SiftUp(i);
+        }
+    }
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline const T& DaryHeap<T, D, Compare, TrackPositions>::Top() const noexcept
+{
+    assert(!Empty());
+    return items_[0];
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline T DaryHeap<T, D, Compare, TrackPositions>::Pop()
+{
+    assert(!Empty());
+    if constexpr (TrackPositions)
+    {
+        free_handles_.PushBack(handles_[0]);
+        positions_[handles_[0]] = kNoHandle;
+    }
+    T top = std::move(items_[0]);
+    const size_t size = items_.Size() - 1;
+    if (size == 0)
+    {
+        items_.PopBack();
+        handles_.Clear();
+        return top;
+    }
+    T value = std::move(items_[size]);
+    Handle handle = kNoHandle;
+    if constexpr (TrackPositions)
+    {
+        handle = handles_[size];
+        handles_.PopBack();
+    }
+    items_.PopBack();
+
+    // The last leaf almost always belongs near the bottom, so walk the hole all
+    // the way down first and sift back up from there: one comparison per level
+    // fewer than a plain sift-down.
+    size_t index = 0;
+    for (size_t first = 1; first < size; first = index * D + 1)
+    {
+        const size_t best = BestChild(first, size);
+        Handle child_handle = kNoHandle;
+        if constexpr (TrackPositions)
+        {
+            child_handle = handles_[best];
+        }
+        Place(index, std::move(items_[best]), child_handle);
+        index = best;
+    }
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / D;
+        if (!compare_(items_[parent], value))
+        {
+            break;
+        }
+        Handle parent_handle = kNoHandle;
+        if constexpr (TrackPositions)
+        {
+            parent_handle = handles_[parent];
+        }
+        Place(index, std::move(items_[parent]), parent_handle);
+        index = parent;
+    }
+    Place(index, std::move(value), handle);
+    return top;
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline const T& DaryHeap<T, D, Compare, TrackPositions>::Get(Handle handle) const noexcept
+{
+    static_assert(TrackPositions, "Get needs TrackPositions");
+    assert(handle < positions_.Size() && positions_[handle] != kNoHandle);
+    return items_[positions_[handle]];
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline void DaryHeap<T, D, Compare, TrackPositions>::DecreaseKey(Handle handle, T value)
+{
+    static_assert(TrackPositions, "DecreaseKey needs TrackPositions");
+    assert(handle < positions_.Size() && positions_[handle] != kNoHandle);
+    const size_t index = positions_[handle];
+    assert(!compare_(value, items_[index]));
+    items_[index] = std::move(value);
+    SiftUp(index);
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline typename DaryHeap<T, D, Compare, TrackPositions>::Handle DaryHeap<T, D, Compare, TrackPositions>::AcquireHandle(size_t index)
+{
+    if constexpr (TrackPositions)
+    {
+        Handle handle;
+        if (free_handles_.Size() != 0)
+        {
+            handle = free_handles_[free_handles_.Size() - 1];
+            free_handles_.PopBack();
+            positions_[handle] = index;
+        }
+        else
+        {
+            handle = positions_.Size();
+            positions_.PushBack(index);
+        }
+        handles_.PushBack(handle);
+        return handle;
+    }
+    else
+    {
+        return kNoHandle;
+    }
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline void DaryHeap<T, D, Compare, TrackPositions>::Place(size_t index, T&& value, [[maybe_unused]] Handle handle) noexcept
+{
+    items_[index] = std::move(value);
+    if constexpr (TrackPositions)
+    {
+        handles_[index] = handle;
+        positions_[handle] = index;
+    }
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline size_t DaryHeap<T, D, Compare, TrackPositions>::BestChild(size_t first, size_t size) const
+{
+    size_t best = first;
+    if (first + D <= size)
+    {
+        // Full sibling group: a fixed trip count the compiler can unroll.
+        for (size_t offset = 1; offset < D; ++offset)
+        {
+            best = compare_(items_[best], items_[first + offset]) ? first + offset : best;
+        }
+    }
+    else
+    {
+        for (size_t child = first + 1; child < size; ++child)
+        {
+            best = compare_(items_[best], items_[child]) ? child : best;
+        }
+    }
+    return best;
+}
+
+// Both sifts move a hole instead of swapping: one move per level, not three.
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline void DaryHeap<T, D, Compare, TrackPositions>::SiftUp(size_t index)
+{
+    T value = std::move(items_[index]);
+    Handle handle = kNoHandle;
+    if constexpr (TrackPositions)
+    {
+        handle = handles_[index];
+    }
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / D;
+        if (!compare_(items_[parent], value))
+        {
+            break;
+        }
+        Handle parent_handle = kNoHandle;
+        if constexpr (TrackPositions)
+        {
+            parent_handle = handles_[parent];
+        }
+        Place(index, std::move(items_[parent]), parent_handle);
+        index = parent;
+    }
+    Place(index, std::move(value), handle);
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline void DaryHeap<T, D, Compare, TrackPositions>::SiftDown(size_t index)
+{
+    const size_t size = items_.Size();
+    T value = std::move(items_[index]);
+    Handle handle = kNoHandle;
+    if constexpr (TrackPositions)
+    {
+        handle = handles_[index];
+    }
+    for (;;)
+    {
+        const size_t first = index * D + 1;
+        if (first >= size)
+        {
+            break;
+        }
+        const size_t best = BestChild(first, size);
+        if (!compare_(value, items_[best]))
+        {
+            break;
+        }
+        Handle child_handle = kNoHandle;
+        if constexpr (TrackPositions)
+        {
+            child_handle = handles_[best];
+        }
+        Place(index, std::move(items_[best]), child_handle);
+        index = best;
+    }
+    Place(index, std::move(value), handle);
+}
+
+template<typename T, size_t D, typename Compare, bool TrackPositions>
+inline void DaryHeap<T, D, Compare, TrackPositions>::Rebuild()
+{
+    const size_t size = items_.Size();
+    if (size < 2)
+    {
+        return;
+    }
+    for (size_t i = (size - 2) / D + 1; i-- > 0;)
+    {
+        SiftDown(i);
+    }
+}
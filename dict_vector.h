@@ -0,0 +1,443 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "memory_footprint.h"
+#include "vector.h"
+
+// A column of few distinct values: every distinct value is stored once in
+// Dictionary() and each element is a code indexing it. Codes start one byte
+// wide and widen to two and then four bytes as the dictionary outgrows them.
+// Codes are assigned in order of first appearance and never reused, so
+// filters and group-bys run on integer codes instead of T.
+template <typename T, typename Hash = std::hash<T>>
+class DictVector
+{
+public:
+    static constexpr uint32_t kNoCode = std::numeric_limits<uint32_t>::max();
+
+    DictVector() = default;
+
+    size_t Size() const noexcept;
+    size_t DictionarySize() const noexcept;
+    // Bytes per code: 1, 2 or 4.
+    size_t CodeWidth() const noexcept;
+    const Vector<T>& Dictionary() const noexcept;
+
+    void Reserve(size_t size);
+
+    void PushBack(const T& value);
+    template <typename It>
+    void Append(It first, It last);
+    void Set(size_t index, const T& value);
+
+    // Drops the elements but keeps the dictionary and its codes.
+    void Clear() noexcept;
+
+    uint32_t CodeAt(size_t index) const noexcept;
+    // Code of value, or kNoCode if it never occurred.
+    uint32_t Find(const T& value) const;
+
+    // Indices of the elements equal to value, in increasing order.
+    Vector<size_t> Where(const T& value) const;
+    size_t Count(const T& value) const;
+
+    // Occurrences of every code; the result has DictionarySize() entries.
+    Vector<size_t> CountByCode() const;
+
+    // One accumulator per code, starting from init; fold(accumulator, index)
+    // is called for every element in index order.
+    template <typename Acc, typename Fold>
+    Vector<Acc> AggregateByCode(const Acc& init, Fold fold) const;
+
+    // Appends the decoded values to out.
+    void DecodeInto(Vector<T>& out) const;
+    Vector<T> Decode() const;
+
+    Footprint MemoryFootprint() const noexcept;
+
+    const T& operator[](size_t index) const noexcept;
+
+private:
+    uint32_t Intern(const T& value);
+    uint32_t FindSlot(const T& value, size_t hash) const;
+    static size_t HomeSlot(size_t hash, size_t mask) noexcept;
+    void GrowSlots();
+    void WidenCodes();
+    void StoreCode(size_t index, uint32_t code);
+    void PushCode(uint32_t code);
+
+    template <typename F>
+    decltype(auto) VisitCodes(F&& visit) const;
+
+    Vector<T> dictionary_;
+    Vector<size_t> hashes_;
+    // Open addressing over the dictionary; a slot holds code + 1, 0 is empty.
+    Vector<uint32_t> slots_;
+    Vector<uint8_t> codes8_;
+    Vector<uint16_t> codes16_;
+    Vector<uint32_t> codes32_;
+    size_t width_ = 1;
+};
+
+//----------------------------DictVector------------------------------------------------
+
+template<typename T, typename Hash>
+inline size_t DictVector<T, Hash>::Size() const noexcept
+{
+    return VisitCodes([](const auto& codes) { return codes.Size(); });
+}
+
+template<typename T, typename Hash>
+inline size_t DictVector<T, Hash>::DictionarySize() const noexcept
+{
+    return dictionary_.Size();
+}
+
+template<typename T, typename Hash>
+inline size_t DictVector<T, Hash>::CodeWidth() const noexcept
+{
+    return width_;
+}
+
+template<typename T, typename Hash>
+inline const Vector<T>& DictVector<T, Hash>::Dictionary() const noexcept
+{
+    return dictionary_;
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::Reserve(size_t size)
+{
+    switch (width_)
+    {
+    case 1:
+        codes8_.Reserve(size);
+        break;
+    case 2:
+        codes16_.Reserve(size);
+        break;
+    default:
+        codes32_.Reserve(size);
+        break;
+    }
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::PushBack(const T& value)
+{
+    PushCode(Intern(value));
+}
+
+template<typename T, typename Hash>
+template<typename It>
+inline void DictVector<T, Hash>::Append(It first, It last)
+{
+    for (; first != last; ++first)
+    {
+        PushBack(*first);
+    }
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::Set(size_t index, const T& value)
+{
+    assert(index < Size());
+    StoreCode(index, Intern(value));
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::Clear() noexcept
+{
+    codes8_.Clear();
+    codes16_.Clear();
+    codes32_.Clear();
+}
+
+template<typename T, typename Hash>
+inline uint32_t DictVector<T, Hash>::CodeAt(size_t index) const noexcept
+{
+    assert(index < Size());
+    return VisitCodes([index](const auto& codes) { return static_cast<uint32_t>(codes[index]); });
+}
+
+template<typename T, typename Hash>
+inline uint32_t DictVector<T, Hash>::Find(const T& value) const
+{
+    if (slots_.Size() == 0)
+    {
+        return kNoCode;
+    }
+    const uint32_t slot = slots_[FindSlot(value, Hash{}(value))];
+    return slot == 0 ? kNoCode : slot - 1;
+}
+
+template<typename T, typename Hash>
+inline Vector<size_t> DictVector<T, Hash>::Where(const T& value) const
+{
+    Vector<size_t> result;
+    const uint32_t code = Find(value);
+    if (code == kNoCode)
+    {
+        return result;
+    }
+    VisitCodes([&](const auto& codes) {
+        using Code = std::decay_t<decltype(codes[0])>;
+        const Code needle = static_cast<Code>(code);
+        for (size_t i = 0; i < codes.Size(); ++i)
+        {
+            if (codes[i] == needle)
+            {
+                result.PushBack(i);
+            }
+        }
+        });
+    return result;
+}
+
+template<typename T, typename Hash>
+inline size_t DictVector<T, Hash>::Count(const T& value) const
+{
+    const uint32_t code = Find(value);
+    if (code == kNoCode)
+    {
+        return 0;
+    }
+    return VisitCodes([code](const auto& codes) {
+        using Code = std::decay_t<decltype(codes[0])>;
+        return static_cast<size_t>(std::count(codes.begin(), codes.end(), static_cast<Code>(code)));
+        });
+}
+
+template<typename T, typename Hash>
+inline Vector<size_t> DictVector<T, Hash>::CountByCode() const
+{
+    Vector<size_t> counts(dictionary_.Size());
+    VisitCodes([&counts](const auto& codes) {
+        for (const auto code : codes)
+        {
+            ++counts[code];
+        }
+        });
+    return counts;
+}
+
+template<typename T, typename Hash>
+template<typename Acc, typename Fold>
+inline Vector<Acc> DictVector<T, Hash>::AggregateByCode(const Acc& init, Fold fold) const
+{
+    Vector<Acc> result;
+    result.Reserve(dictionary_.Size());
+    for (size_t i = 0; i < dictionary_.Size(); ++i)
+    {
+        result.PushBack(init);
+    }
+    VisitCodes([&](const auto& codes) {
+        for (size_t i = 0; i < codes.Size(); ++i)
+        {
+            fold(result[codes[i]], i);
+        }
+        });
+    return result;
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::DecodeInto(Vector<T>& out) const
+{
+    out.Reserve(out.Size() + Size());
+    VisitCodes([&](const auto& codes) {
+        for (const auto code : codes)
+        {
+            out.PushBack(dictionary_[code]);
+        }
+        });
+}
+
+template<typename T, typename Hash>
+inline Vector<T> DictVector<T, Hash>::Decode() const
+{
+    Vector<T> result;
+    DecodeInto(result);
+    return result;
+}
+
+template<typename T, typename Hash>
+inline Footprint DictVector<T, Hash>::MemoryFootprint() const noexcept
+{
+    return dictionary_.MemoryFootprint() + hashes_.MemoryFootprint() + slots_.MemoryFootprint()
+        + codes8_.MemoryFootprint() + codes16_.MemoryFootprint() + codes32_.MemoryFootprint();
+}
+
+template<typename T, typename Hash>
+inline uint32_t DictVector<T, Hash>::Intern(const T& value)
+{
+    if ((dictionary_.Size() + 1) * 2 > slots_.Size())
+    {
+        GrowSlots();
+    }
+    const size_t hash = Hash{}(value);
+    const uint32_t slot = FindSlot(value, hash);
+    if (slots_[slot] != 0)
+    {
+        return slots_[slot] - 1;
+    }
+    if (dictionary_.Size() >= kNoCode)
+    {
+        throw std::length_error("DictVector dictionary exceeds the code range");
+    }
+    const uint32_t code = static_cast<uint32_t>(dictionary_.Size());
+    if (width_ < 4 && code >> (width_ * 8) != 0)
+    {
+        WidenCodes();
+    }
+    // Made room for first so that both pushes below succeed or neither does;
+    // doubled like PushBack would, or interning turns quadratic.
+    if (hashes_.Size() == hashes_.Capacity())
+    {
+        hashes_.Reserve(std::max(hashes_.Size() + 1, hashes_.Size() * 2));
+    }
+    dictionary_.PushBack(value);
+    hashes_.PushBack(hash);
+    slots_[slot] = code + 1;
+    return code;
+}
+
+template<typename T, typename Hash>
+inline uint32_t DictVector<T, Hash>::FindSlot(const T& value, size_t hash) const
+{
+    const size_t mask = slots_.Size() - 1;
+    size_t slot = HomeSlot(hash, mask);
+    while (slots_[slot] != 0)
+    {
+        const uint32_t code = slots_[slot] - 1;
+        if (hashes_[code] == hash && dictionary_[code] == value)
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return static_cast<uint32_t>(slot);
+}
+
+template<typename T, typename Hash>
+inline size_t DictVector<T, Hash>::HomeSlot(size_t hash, size_t mask) noexcept
+{
+    // std::hash is the identity for integers, so strided values would share
+    // their low bits; the murmur3 finalizer mixes every bit into them.
+    uint64_t bits = static_cast<uint64_t>(hash);
+    bits ^= bits >> 33;
+    bits *= 0xFF51AFD7ED558CCDULL;
+    bits ^= bits >> 33;
+    bits *= 0xC4CEB9FE1A85EC53ULL;
+    bits ^= bits >> 33;
+    return static_cast<size_t>(bits) & mask;
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::GrowSlots()
+{
+    Vector<uint32_t> slots(std::max<size_t>(slots_.Size() * 2, 16));
+    const size_t mask = slots.Size() - 1;
+    for (size_t code = 0; code < dictionary_.Size(); ++code)
+    {
+        size_t slot = HomeSlot(hashes_[code], mask);
+        while (slots[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = static_cast<uint32_t>(code + 1);
+    }
+    slots_.Swap(slots);
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::WidenCodes()
+{
+    if (width_ == 1)
+    {
+        Vector<uint16_t> wide;
+        wide.Reserve(codes8_.Capacity());
+        for (const uint8_t code : codes8_)
+        {
+            wide.PushBack(code);
+        }
+        codes16_.Swap(wide);
+        codes8_.ClearAndTrim();
+        width_ = 2;
+    }
+    else
+    {
+        Vector<uint32_t> wide;
+        wide.Reserve(codes16_.Capacity());
+        for (const uint16_t code : codes16_)
+        {
+            wide.PushBack(code);
+        }
+        codes32_.Swap(wide);
+        codes16_.ClearAndTrim();
+        width_ = 4;
+    }
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::StoreCode(size_t index, uint32_t code)
+{
+    switch (width_)
+    {
+    case 1:
+        codes8_[index] = static_cast<uint8_t>(code);
+        break;
+    case 2:
+        codes16_[index] = static_cast<uint16_t>(code);
+        break;
+    default:
+        codes32_[index] = code;
+        break;
+    }
+}
+
+template<typename T, typename Hash>
+inline void DictVector<T, Hash>::PushCode(uint32_t code)
+{
+    switch (width_)
+    {
+    case 1:
+        codes8_.PushBack(static_cast<uint8_t>(code));
+        break;
+    case 2:
+        codes16_.PushBack(static_cast<uint16_t>(code));
+        break;
+    default:
+        codes32_.PushBack(code);
+        break;
+    }
+}
+
+template<typename T, typename Hash>
+template<typename F>
+inline decltype(auto) DictVector<T, Hash>::VisitCodes(F&& visit) const
+{
+    switch (width_)
+    {
+    case 1:
+        return visit(codes8_);
+    case 2:
+        return visit(codes16_);
+    default:
+        return visit(codes32_);
+    }
+}
+
+//------------Operators-------------
+
+template<typename T, typename Hash>
+inline const T& DictVector<T, Hash>::operator[](size_t index) const noexcept
+{
+    return dictionary_[CodeAt(index)];
+}
@@ -0,0 +1,295 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "memory_footprint.h"
+#include "vector.h"
+
+// Low-latency growth mode. When the buffer is full a new one of twice the
+// capacity is allocated, but the old elements are relocated a few at a time on
+// the following pushes instead of all at once. While a migration is in flight
+// element i lives in the old buffer when migrated_ <= i < old_size_, otherwise
+// in the new one. Each push moves kMigrationStep elements, so the migration is
+// always over before the new buffer fills up.
+// Relocation happens inside noexcept calls such as begin() and PopBack(), and a
+// half-finished migration has no way to roll back, so T must be nothrow
+// move-constructible.
+template <typename T>
+class IncrementalVector
+{
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+        "IncrementalVector relocates elements from noexcept functions");
+
+public:
+    static constexpr size_t kMigrationStep = 2;
+
+    IncrementalVector() = default;
+
+    IncrementalVector(const IncrementalVector&) = delete;
+    IncrementalVector& operator=(const IncrementalVector&) = delete;
+
+    IncrementalVector(IncrementalVector&& other) noexcept;
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept;
+
+    ~IncrementalVector() noexcept;
+
+    using iterator = T*;
+
+    // Iteration needs contiguous storage, so it completes a pending migration.
+    iterator begin() noexcept;
+    iterator end() noexcept;
+
+    void Reserve(size_t new_capacity);
+
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+
+    template<typename ... Args>
+    T& EmplaceBack(Args&&... args);
+
+    void PopBack() noexcept;
+
+    void FinishMigration() noexcept;
+    bool IsMigrating() const noexcept;
+
+    void Swap(IncrementalVector& rhs) noexcept;
+
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+
+    Footprint MemoryFootprint() const noexcept;
+
+    const T& operator[](size_t index) const noexcept;
+    T& operator[](size_t index) noexcept;
+
+private:
+    void Grow();
+    void MigrateStep(size_t count) noexcept;
+    static void Relocate(T* from, T* to) noexcept;
+
+    RawMemory<T> data_;
+    RawMemory<T> old_data_;
+    size_t size_ = 0;
+    size_t old_size_ = 0;
+    size_t migrated_ = 0;
+};
+
+//------Costructer and destructor-----
+
+template<typename T>
+inline IncrementalVector<T>::IncrementalVector(IncrementalVector&& other) noexcept
+{
+    Swap(other);
+}
+
+template<typename T>
+inline IncrementalVector<T>& IncrementalVector<T>::operator=(IncrementalVector&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        Swap(rhs);
+    }
+    return *this;
+}
+
+template<typename T>
+inline IncrementalVector<T>::~IncrementalVector() noexcept
+{
+    if (IsMigrating())
+    {
+        std::destroy_n(old_data_.GetAddress() + migrated_, old_size_ - migrated_);
+        std::destroy_n(data_.GetAddress(), migrated_);
+        std::destroy_n(data_.GetAddress() + old_size_, size_ - old_size_);
+    }
+    else
+    {
+        std::destroy_n(data_.GetAddress(), size_);
+    }
+}
+
+//-----------Iterators--------
+
+template<typename T>
+inline T* IncrementalVector<T>::begin() noexcept
+{
+    FinishMigration();
+    return data_.GetAddress();
+}
+
+template<typename T>
+inline T* IncrementalVector<T>::end() noexcept
+{
+    return begin() + size_;
+}
+
+//------------Methods--------------
+
+template<typename T>
+inline void IncrementalVector<T>::Reserve(size_t new_capacity)
+{
+    FinishMigration();
+    if (new_capacity <= data_.Capacity())
+    {
+        return;
+    }
+    RawMemory<T> new_data(new_capacity);
+    for (size_t i = 0; i < size_; ++i)
+    {
+        Relocate(data_.GetAddress() + i, new_data.GetAddress() + i);
+    }
+    data_.Swap(new_data);
+}
+
+template<typename T>
+inline void IncrementalVector<T>::PushBack(const T& value)
+{
+    EmplaceBack(value);
+}
+
+template<typename T>
+inline void IncrementalVector<T>::PushBack(T&& value)
+{
+    EmplaceBack(std::move(value));
+}
+
+template<typename T>
+template<typename ...Args>
+inline T& IncrementalVector<T>::EmplaceBack(Args && ...args)
+{
+    if (size_ == data_.Capacity())
+    {
+        Grow();
+    }
+    // Construct before migrating so that args referring to an element stay valid.
+    T* slot = new(data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+    ++size_;
+    if (IsMigrating())
+    {
+        MigrateStep(kMigrationStep);
+    }
+    return *slot;
+}
+
+template<typename T>
+inline void IncrementalVector<T>::PopBack() noexcept
+{
+    assert(size_ != 0);
+    if (size_ <= old_size_)
+    {
+        FinishMigration();
+    }
+    std::destroy_at(&(*this)[size_ - 1]);
+    --size_;
+}
+
+template<typename T>
+inline void IncrementalVector<T>::FinishMigration() noexcept
+{
+    if (IsMigrating())
+    {
+        MigrateStep(old_size_ - migrated_);
+    }
+}
+
+template<typename T>
+inline bool IncrementalVector<T>::IsMigrating() const noexcept
+{
+    return old_data_.Capacity() != 0;
+}
+
+template<typename T>
+inline void IncrementalVector<T>::Swap(IncrementalVector& rhs) noexcept
+{
+    data_.Swap(rhs.data_);
+    old_data_.Swap(rhs.old_data_);
+    std::swap(size_, rhs.size_);
+    std::swap(old_size_, rhs.old_size_);
+    std::swap(migrated_, rhs.migrated_);
+}
+
+template<typename T>
+inline size_t IncrementalVector<T>::Size() const noexcept
+{
+    return size_;
+}
+
+template<typename T>
+inline size_t IncrementalVector<T>::Capacity() const noexcept
+{
+    return data_.Capacity();
+}
+
+template<typename T>
+inline Footprint IncrementalVector<T>::MemoryFootprint() const noexcept
+{
+    Footprint result;
+    result.used_bytes = size_ * sizeof(T);
+    result.reserved_bytes = (data_.Capacity() + old_data_.Capacity()) * sizeof(T);
+    result.slack_bytes = result.reserved_bytes - result.used_bytes;
+    if constexpr (FootprintTraits<T>::has_nested)
+    {
+        for (size_t i = 0; i < size_; ++i)
+        {
+            result += FootprintTraits<T>::Nested((*this)[i]);
+        }
+    }
+    return result;
+}
+
+template<typename T>
+inline void IncrementalVector<T>::Grow()
+{
+    // The step size guarantees the previous migration is over by now.
+    assert(!IsMigrating());
+    RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+    old_data_.Swap(data_);
+    data_.Swap(new_data);
+    old_size_ = size_;
+    migrated_ = 0;
+}
+
+template<typename T>
+inline void IncrementalVector<T>::MigrateStep(size_t count) noexcept
+{
+    const size_t last = std::min(old_size_, migrated_ + count);
+    for (; migrated_ < last; ++migrated_)
+    {
+        Relocate(old_data_.GetAddress() + migrated_, data_.GetAddress() + migrated_);
+    }
+    if (migrated_ == old_size_)
+    {
+        RawMemory<T> released;
+        old_data_.Swap(released);
+        old_size_ = 0;
+        migrated_ = 0;
+    }
+}
+
+template<typename T>
+inline void IncrementalVector<T>::Relocate(T* from, T* to) noexcept
+{
+    new(to) T(std::move(*from));
+    std::destroy_at(from);
+}
+
+//------------Operators-------------
+
+template<typename T>
+inline const T& IncrementalVector<T>::operator[](size_t index) const noexcept
+{
+    return const_cast<IncrementalVector&>(*this)[index];
+}
+
+template<typename T>
+inline T& IncrementalVector<T>::operator[](size_t index) noexcept
+{
+    assert(index < size_);
+    if (index >= migrated_ && index < old_size_)
+    {
+        return old_data_[index];
+    }
+    return data_[index];
+}
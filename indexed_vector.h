@@ -0,0 +1,429 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define INDEXED_VECTOR_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "vector.h"
+
+// Elements live contiguously in a Vector; an open-addressing table of
+// positions into that Vector gives O(1) lookup by key. The table stores
+// indices, not pointers, so the Vector may reallocate freely. Each slot has a
+// control byte (empty, deleted, or 7 bits of the hash) and lookups scan the
+// control bytes 16 at a time, with SSE2 when it is available.
+//
+// Keys are unique. Erase is swap-and-pop, so it does not preserve order.
+// Mutable access must not change an element's key.
+template <typename T, typename KeyFn, typename Hash = std::hash<std::decay_t<std::invoke_result_t<const KeyFn&, const T&>>>>
+class IndexedVector
+{
+public:
+    using Key = std::decay_t<std::invoke_result_t<const KeyFn&, const T&>>;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    explicit IndexedVector(KeyFn key_fn = {}, Hash hash = {});
+
+    // Adds value unless an element with the same key is present; returns whether it was added.
+    bool PushBack(const T& value);
+    bool PushBack(T&& value);
+
+    T* Find(const Key& key) noexcept;
+    const T* Find(const Key& key) const noexcept;
+    bool Contains(const Key& key) const noexcept;
+
+    bool EraseKey(const Key& key);
+    void EraseAt(size_t index);
+
+    // Replaces the contents and builds the index in one pass; elements with a
+    // key seen earlier are dropped.
+    void Assign(Vector<T>&& values);
+    void Rebuild();
+
+    void Reserve(size_t count);
+
+    size_t Size() const noexcept;
+    const Vector<T>& Items() const noexcept;
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    const T& operator[](size_t index) const noexcept;
+    T& operator[](size_t index) noexcept;
+
+private:
+    static constexpr int8_t kEmpty = -128;
+    static constexpr int8_t kDeleted = -2;
+    static constexpr size_t kGroupSize = 16;
+
+    struct Probe
+    {
+        size_t slot;
+        bool found;
+    };
+
+    size_t HashOf(const Key& key) const noexcept;
+    static uint32_t MatchByte(const int8_t* group, int8_t value) noexcept;
+    static size_t LowestBit(uint32_t mask) noexcept;
+
+    Probe FindSlot(const Key& key, size_t hash) const noexcept;
+    size_t FindInsertSlot(size_t hash) const noexcept;
+    void SetSlot(size_t slot, size_t hash, size_t position) noexcept;
+    void GrowIfNeeded();
+    void Rehash(size_t slot_count);
+
+    template <typename U>
+    bool Add(U&& value);
+
+    Vector<T> items_;
+    Vector<int8_t> control_;
+    Vector<size_t> positions_;
+    size_t used_slots_ = 0;
+    KeyFn key_fn_;
+    Hash hash_;
+};
+
+//------Costructer-----
+
+template<typename T, typename KeyFn, typename Hash>
+inline IndexedVector<T, KeyFn, Hash>::IndexedVector(KeyFn key_fn, Hash hash)
+    : key_fn_(std::move(key_fn))
+    , hash_(std::move(hash))
+{}
+
+//------------Methods--------------
+
+template<typename T, typename KeyFn, typename Hash>
+inline bool IndexedVector<T, KeyFn, Hash>::PushBack(const T& value)
+{
+    return Add(value);
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline bool IndexedVector<T, KeyFn, Hash>::PushBack(T&& value)
+{
+    return Add(std::move(value));
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline T* IndexedVector<T, KeyFn, Hash>::Find(const Key& key) noexcept
+{
+    return const_cast<T*>(static_cast<const IndexedVector&>(*this).Find(key));
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline const T* IndexedVector<T, KeyFn, Hash>::Find(const Key& key) const noexcept
+{
+    if (control_.Size() == 0)
+    {
+        return nullptr;
+    }
+    const Probe probe = FindSlot(key, HashOf(key));
+    return probe.found ? &items_[positions_[probe.slot]] : nullptr;
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline bool IndexedVector<T, KeyFn, Hash>::Contains(const Key& key) const noexcept
+{
+    return Find(key) != nullptr;
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline bool IndexedVector<T, KeyFn, Hash>::EraseKey(const Key& key)
+{
+    if (control_.Size() == 0)
+    {
+        return false;
+    }
+    const Probe probe = FindSlot(key, HashOf(key));
+    if (!probe.found)
+    {
+        return false;
+    }
+    EraseAt(positions_[probe.slot]);
+    return true;
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline void IndexedVector<T, KeyFn, Hash>::EraseAt(size_t index)
+{
+    assert(index < items_.Size());
+    const Probe erased = FindSlot(key_fn_(items_[index]), HashOf(key_fn_(items_[index])));
+    assert(erased.found);
+    control_[erased.slot] = kDeleted;
+
+    const size_t last = items_.Size() - 1;
+    if (index != last)
+    {
+        const Probe moved = FindSlot(key_fn_(items_[last]), HashOf(key_fn_(items_[last])));
+        assert(moved.found);
+        positions_[moved.slot] = index;
+        items_[index] = std::move(items_[last]);
+    }
+    items_.PopBack();
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline void IndexedVector<T, KeyFn, Hash>::Assign(Vector<T>&& values)
+{
+    items_ = std::move(values);
+    Rebuild();
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline void IndexedVector<T, KeyFn, Hash>::Rebuild()
+{
+    size_t slot_count = kGroupSize;
+    while (slot_count * 7 / 8 < items_.Size())
+    {
+        slot_count *= 2;
+    }
+    Vector<int8_t> control(slot_count);
+    std::fill(control.begin(), control.end(), kEmpty);
+    control_.Swap(control);
+    Vector<size_t> positions(slot_count);
+    positions_.Swap(positions);
+    used_slots_ = 0;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < items_.Size(); ++i)
+    {
+        const size_t hash = HashOf(key_fn_(items_[i]));
+        if (FindSlot(key_fn_(items_[i]), hash).found)
+        {
+            continue;
+        }
+        if (kept != i)
+        {
+            items_[kept] = std::move(items_[i]);
+        }
+        SetSlot(FindInsertSlot(hash), hash, kept);
+        ++kept;
+    }
+    while (items_.Size() > kept)
+    {
+        items_.PopBack();
+    }
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline void IndexedVector<T, KeyFn, Hash>::Reserve(size_t count)
+{
+    items_.Reserve(count);
+    if (control_.Size() * 7 / 8 < count)
+    {
+        size_t slot_count = std::max(control_.Size(), kGroupSize);
+        while (slot_count * 7 / 8 < count)
+        {
+            slot_count *= 2;
+        }
+        Rehash(slot_count);
+    }
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline size_t IndexedVector<T, KeyFn, Hash>::Size() const noexcept
+{
+    return items_.Size();
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline const Vector<T>& IndexedVector<T, KeyFn, Hash>::Items() const noexcept
+{
+    return items_;
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline size_t IndexedVector<T, KeyFn, Hash>::HashOf(const Key& key) const noexcept
+{
+    // std::hash is the identity for integers and a multiply alone never moves
+    // high input bits down, so keys differing only there (multiples of 2^k)
+    // would share their low group bits. The murmur3 finalizer mixes every
+    // input bit into both the low bits (group) and the top seven (tag).
+    uint64_t bits = static_cast<uint64_t>(hash_(key));
+    bits ^= bits >> 33;
+    bits *= 0xFF51AFD7ED558CCDULL;
+    bits ^= bits >> 33;
+    bits *= 0xC4CEB9FE1A85EC53ULL;
+    bits ^= bits >> 33;
+    return static_cast<size_t>(bits);
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline uint32_t IndexedVector<T, KeyFn, Hash>::MatchByte(const int8_t* group, int8_t value) noexcept
+{
+#ifdef INDEXED_VECTOR_SSE2
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; ++i)
+    {
+        mask |= static_cast<uint32_t>(group[i] == value) << i;
+    }
+    return mask;
+#endif
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline size_t IndexedVector<T, KeyFn, Hash>::LowestBit(uint32_t mask) noexcept
+{
+    assert(mask != 0);
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctz(mask));
+#endif
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline typename IndexedVector<T, KeyFn, Hash>::Probe IndexedVector<T, KeyFn, Hash>::FindSlot(const Key& key, size_t hash) const noexcept
+{
+    const size_t group_mask = control_.Size() / kGroupSize - 1;
+    const int8_t tag = static_cast<int8_t>(hash >> (sizeof(size_t) * 8 - 7));
+    size_t group = hash & group_mask;
+    for (size_t step = 1; step <= group_mask + 1; ++step)
+    {
+        const int8_t* control = control_.begin() + group * kGroupSize;
+        for (uint32_t match = MatchByte(control, tag); match != 0; match &= match - 1)
+        {
+            const size_t slot = group * kGroupSize + LowestBit(match);
+            if (key_fn_(items_[positions_[slot]]) == key)
+            {
+                return { slot, true };
+            }
+        }
+        if (MatchByte(control, kEmpty) != 0)
+        {
+            break;
+        }
+        group = (group + step) & group_mask;
+    }
+    return { 0, false };
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline size_t IndexedVector<T, KeyFn, Hash>::FindInsertSlot(size_t hash) const noexcept
+{
+    const size_t group_mask = control_.Size() / kGroupSize - 1;
+    size_t group = hash & group_mask;
+    for (size_t step = 1;; ++step)
+    {
+        const int8_t* control = control_.begin() + group * kGroupSize;
+        const uint32_t free = MatchByte(control, kEmpty) | MatchByte(control, kDeleted);
+        if (free != 0)
+        {
+            return group * kGroupSize + LowestBit(free);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline void IndexedVector<T, KeyFn, Hash>::SetSlot(size_t slot, size_t hash, size_t position) noexcept
+{
+    if (control_[slot] == kEmpty)
+    {
+        ++used_slots_;
+    }
+    control_[slot] = static_cast<int8_t>(hash >> (sizeof(size_t) * 8 - 7));
+    positions_[slot] = position;
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline void IndexedVector<T, KeyFn, Hash>::GrowIfNeeded()
+{
+    // Tombstones count towards the load, so a table full of them is rehashed in place.
+    if ((used_slots_ + 1) * 8 > control_.Size() * 7)
+    {
+        const size_t live = items_.Size() + 1;
+        Rehash(live * 8 > control_.Size() * 7 / 2 ? std::max(control_.Size() * 2, kGroupSize) : control_.Size());
+    }
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline void IndexedVector<T, KeyFn, Hash>::Rehash(size_t slot_count)
+{
+    Vector<int8_t> control(slot_count);
+    std::fill(control.begin(), control.end(), kEmpty);
+    control_.Swap(control);
+    Vector<size_t> positions(slot_count);
+    positions_.Swap(positions);
+    used_slots_ = 0;
+    for (size_t i = 0; i < items_.Size(); ++i)
+    {
+        const size_t hash = HashOf(key_fn_(items_[i]));
+        SetSlot(FindInsertSlot(hash), hash, i);
+    }
+}
+
+template<typename T, typename KeyFn, typename Hash>
+template<typename U>
+inline bool IndexedVector<T, KeyFn, Hash>::Add(U&& value)
+{
+    GrowIfNeeded();
+    const size_t hash = HashOf(key_fn_(value));
+    if (FindSlot(key_fn_(value), hash).found)
+    {
+        return false;
+    }
+    const size_t slot = FindInsertSlot(hash);
+    items_.PushBack(std::forward<U>(value));
+    SetSlot(slot, hash, items_.Size() - 1);
+    return true;
+}
+
+//-----------Iterators--------
+
+template<typename T, typename KeyFn, typename Hash>
+inline T* IndexedVector<T, KeyFn, Hash>::begin() noexcept
+{
+    return items_.begin();
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline T* IndexedVector<T, KeyFn, Hash>::end() noexcept
+{
+    return items_.end();
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline const T* IndexedVector<T, KeyFn, Hash>::begin() const noexcept
+{
+    return items_.begin();
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline const T* IndexedVector<T, KeyFn, Hash>::end() const noexcept
+{
+    return items_.end();
+}
+
+//------------Operators-------------
+
+template<typename T, typename KeyFn, typename Hash>
+inline const T& IndexedVector<T, KeyFn, Hash>::operator[](size_t index) const noexcept
+{
+    return items_[index];
+}
+
+template<typename T, typename KeyFn, typename Hash>
+inline T& IndexedVector<T, KeyFn, Hash>::operator[](size_t index) noexcept
+{
+    return items_[index];
+}
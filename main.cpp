@@ -1,13 +1,30 @@
 #include "test.h"
+#include "benchmark.h"
 #include <iostream>
 #include <cassert>
 #include <vector>
 using namespace std;
 
 
-int main()
+int main(int argc, char* argv[])
 {   
     TestsForVector();
+
+    if (argc > 1 && argv[1] == "--bench"sv)
+    {
+        BenchmarksForVector();
+    }
+
+    if (argc > 2 && argv[1] == "--replay"sv)
+    {
+        Vector<TraceEvent> events;
+        if (!LoadTrace(argv[2], events))
+        {
+            cerr << "Cannot read trace "sv << argv[2] << endl;
+            return 1;
+        }
+        CompareReplays(cerr, events);
+    }
     
     return 0;
-}
\ No newline at end of file
+}
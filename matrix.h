@@ -0,0 +1,491 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "memory_footprint.h"
+#include "vector.h"
+
+inline constexpr size_t kMatrixAlignment = 64;
+
+// Non-owning window onto a matrix: rows() x cols() elements, consecutive rows
+// `stride` elements apart. T may be const for read-only views.
+template <typename T>
+class MatrixView
+{
+public:
+    MatrixView(T* data, size_t rows, size_t cols, size_t stride) noexcept;
+
+    size_t Rows() const noexcept;
+    size_t Cols() const noexcept;
+    size_t Stride() const noexcept;
+
+    T* RowData(size_t row) const noexcept;
+
+    MatrixView Row(size_t row) const noexcept;
+    MatrixView Column(size_t col) const noexcept;
+    MatrixView Submatrix(size_t row, size_t col, size_t rows, size_t cols) const noexcept;
+
+    T& operator()(size_t row, size_t col) const noexcept;
+
+private:
+    T* data_;
+    size_t rows_;
+    size_t cols_;
+    size_t stride_;
+};
+
+// Dense row-major matrix in a single cache-line aligned buffer. Each row is
+// padded to a whole number of cache lines so that rows start aligned and tiles
+// never share a line with the next row.
+template <typename T>
+class Matrix
+{
+public:
+    Matrix() = default;
+    Matrix(size_t rows, size_t cols);
+    Matrix(size_t rows, size_t cols, const T& value);
+
+    Matrix(const Matrix& other);
+    Matrix(Matrix&& other) noexcept;
+
+    Matrix& operator=(const Matrix& rhs);
+    Matrix& operator=(Matrix&& rhs) noexcept;
+
+    ~Matrix() noexcept;
+
+    size_t Rows() const noexcept;
+    size_t Cols() const noexcept;
+    size_t Stride() const noexcept;
+
+    T* RowData(size_t row) noexcept;
+    const T* RowData(size_t row) const noexcept;
+
+    MatrixView<T> View() noexcept;
+    MatrixView<const T> View() const noexcept;
+    MatrixView<T> Row(size_t row) noexcept;
+    MatrixView<const T> Row(size_t row) const noexcept;
+    MatrixView<T> Column(size_t col) noexcept;
+    MatrixView<const T> Column(size_t col) const noexcept;
+    MatrixView<T> Submatrix(size_t row, size_t col, size_t rows, size_t cols) noexcept;
+    MatrixView<const T> Submatrix(size_t row, size_t col, size_t rows, size_t cols) const noexcept;
+
+    Matrix Transposed() const;
+
+    void Swap(Matrix& rhs) noexcept;
+
+    Footprint MemoryFootprint() const noexcept;
+
+    Matrix& operator+=(const Matrix& rhs);
+    Matrix& operator-=(const Matrix& rhs);
+    Matrix& operator*=(const T& scalar);
+
+    T& operator()(size_t row, size_t col) noexcept;
+    const T& operator()(size_t row, size_t col) const noexcept;
+
+private:
+    static size_t PaddedStride(size_t cols) noexcept;
+    void CheckSameShape(const Matrix& rhs) const;
+
+    RawMemory<T, kMatrixAlignment> data_;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t stride_ = 0;
+};
+
+//----------------------------MatrixView------------------------------------------------
+
+template<typename T>
+inline MatrixView<T>::MatrixView(T* data, size_t rows, size_t cols, size_t stride) noexcept
+    : data_(data)
+    , rows_(rows)
+    , cols_(cols)
+    , stride_(stride)
+{}
+
+template<typename T>
+inline size_t MatrixView<T>::Rows() const noexcept
+{
+    return rows_;
+}
+
+template<typename T>
+inline size_t MatrixView<T>::Cols() const noexcept
+{
+    return cols_;
+}
+
+template<typename T>
+inline size_t MatrixView<T>::Stride() const noexcept
+{
+    return stride_;
+}
+
+template<typename T>
+inline T* MatrixView<T>::RowData(size_t row) const noexcept
+{
+    assert(row < rows_);
+    return data_ + row * stride_;
+}
+
+template<typename T>
+inline MatrixView<T> MatrixView<T>::Row(size_t row) const noexcept
+{
+    return Submatrix(row, 0, 1, cols_);
+}
+
+template<typename T>
+inline MatrixView<T> MatrixView<T>::Column(size_t col) const noexcept
+{
+    return Submatrix(0, col, rows_, 1);
+}
+
+template<typename T>
+inline MatrixView<T> MatrixView<T>::Submatrix(size_t row, size_t col, size_t rows, size_t cols) const noexcept
+{
+    assert(row + rows <= rows_ && col + cols <= cols_);
+    return MatrixView(data_ + row * stride_ + col, rows, cols, stride_);
+}
+
+template<typename T>
+inline T& MatrixView<T>::operator()(size_t row, size_t col) const noexcept
+{
+    assert(row < rows_ && col < cols_);
+    return data_[row * stride_ + col];
+}
+
+//----------------------------Matrix------------------------------------------------
+//------Costructer and destructor-----
+
+template<typename T>
+inline Matrix<T>::Matrix(size_t rows, size_t cols)
+    : data_(rows * PaddedStride(cols))
+    , rows_(rows)
+    , cols_(cols)
+    , stride_(PaddedStride(cols))
+{
+    std::uninitialized_value_construct_n(data_.GetAddress(), rows_ * stride_);
+}
+
+template<typename T>
+inline Matrix<T>::Matrix(size_t rows, size_t cols, const T& value)
+    : data_(rows * PaddedStride(cols))
+    , rows_(rows)
+    , cols_(cols)
+    , stride_(PaddedStride(cols))
+{
+    std::uninitialized_fill_n(data_.GetAddress(), rows_ * stride_, value);
+}
+
+template<typename T>
+inline Matrix<T>::Matrix(const Matrix& other)
+    : data_(other.rows_ * other.stride_)
+    , rows_(other.rows_)
+    , cols_(other.cols_)
+    , stride_(other.stride_)
+{
+    std::uninitialized_copy_n(other.data_.GetAddress(), rows_ * stride_, data_.GetAddress());
+}
+
+template<typename T>
+inline Matrix<T>::Matrix(Matrix&& other) noexcept
+{
+    Swap(other);
+}
+
+template<typename T>
+inline Matrix<T>& Matrix<T>::operator=(const Matrix& rhs)
+{
+    if (this != &rhs)
+    {
+        Matrix copy(rhs);
+        Swap(copy);
+    }
+    return *this;
+}
+
+template<typename T>
+inline Matrix<T>& Matrix<T>::operator=(Matrix&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        Swap(rhs);
+    }
+    return *this;
+}
+
+template<typename T>
+inline Matrix<T>::~Matrix() noexcept
+{
+    std::destroy_n(data_.GetAddress(), rows_ * stride_);
+}
+
+//------------Methods--------------
+
+template<typename T>
+inline size_t Matrix<T>::Rows() const noexcept
+{
+    return rows_;
+}
+
+template<typename T>
+inline size_t Matrix<T>::Cols() const noexcept
+{
+    return cols_;
+}
+
+template<typename T>
+inline size_t Matrix<T>::Stride() const noexcept
+{
+    return stride_;
+}
+
+template<typename T>
+inline T* Matrix<T>::RowData(size_t row) noexcept
+{
+    assert(row < rows_);
+    return data_.GetAddress() + row * stride_;
+}
+
+template<typename T>
+inline const T* Matrix<T>::RowData(size_t row) const noexcept
+{
+    assert(row < rows_);
+    return data_.GetAddress() + row * stride_;
+}
+
+template<typename T>
+inline MatrixView<T> Matrix<T>::View() noexcept
+{
+    return MatrixView<T>(data_.GetAddress(), rows_, cols_, stride_);
+}
+
+template<typename T>
+inline MatrixView<const T> Matrix<T>::View() const noexcept
+{
+    return MatrixView<const T>(data_.GetAddress(), rows_, cols_, stride_);
+}
+
+template<typename T>
+inline MatrixView<T> Matrix<T>::Row(size_t row) noexcept
+{
+    return View().Row(row);
+}
+
+template<typename T>
+inline MatrixView<const T> Matrix<T>::Row(size_t row) const noexcept
+{
+    return View().Row(row);
+}
+
+template<typename T>
+inline MatrixView<T> Matrix<T>::Column(size_t col) noexcept
+{
+    return View().Column(col);
+}
+
+template<typename T>
+inline MatrixView<const T> Matrix<T>::Column(size_t col) const noexcept
+{
+    return View().Column(col);
+}
+
+template<typename T>
+inline MatrixView<T> Matrix<T>::Submatrix(size_t row, size_t col, size_t rows, size_t cols) noexcept
+{
+    return View().Submatrix(row, col, rows, cols);
+}
+
+template<typename T>
+inline MatrixView<const T> Matrix<T>::Submatrix(size_t row, size_t col, size_t rows, size_t cols) const noexcept
+{
+    return View().Submatrix(row, col, rows, cols);
+}
+
+template<typename T>
+inline Matrix<T> Matrix<T>::Transposed() const
+{
+    // Tiles keep both the rows read and the rows written resident in cache.
+    const size_t kTile = 32;
+    Matrix result(cols_, rows_);
+    for (size_t ii = 0; ii < rows_; ii += kTile)
+    {
+        const size_t i_end = std::min(ii + kTile, rows_);
+        for (size_t jj = 0; jj < cols_; jj += kTile)
+        {
+            const size_t j_end = std::min(jj + kTile, cols_);
+            for (size_t i = ii; i < i_end; ++i)
+            {
+                const T* src = RowData(i);
+                for (size_t j = jj; j < j_end; ++j)
+                {
+                    result.RowData(j)[i] = src[j];
+                }
+            }
+        }
+    }
+    return result;
+}
+
+template<typename T>
+inline void Matrix<T>::Swap(Matrix& rhs) noexcept
+{
+    data_.Swap(rhs.data_);
+    std::swap(rows_, rhs.rows_);
+    std::swap(cols_, rhs.cols_);
+    std::swap(stride_, rhs.stride_);
+}
+
+template<typename T>
+inline Footprint Matrix<T>::MemoryFootprint() const noexcept
+{
+    Footprint result;
+    result.used_bytes = rows_ * cols_ * sizeof(T);
+    result.reserved_bytes = data_.Capacity() * sizeof(T);
+    result.slack_bytes = result.reserved_bytes - result.used_bytes;
+    return result;
+}
+
+template<typename T>
+inline size_t Matrix<T>::PaddedStride(size_t cols) noexcept
+{
+    if (kMatrixAlignment % sizeof(T) != 0)
+    {
+        return cols;
+    }
+    const size_t per_line = kMatrixAlignment / sizeof(T);
+    return (cols + per_line - 1) / per_line * per_line;
+}
+
+template<typename T>
+inline void Matrix<T>::CheckSameShape(const Matrix& rhs) const
+{
+    if (rows_ != rhs.rows_ || cols_ != rhs.cols_)
+    {
+        throw std::invalid_argument("Matrix shapes differ");
+    }
+}
+
+//------------Operators-------------
+
+template<typename T>
+inline Matrix<T>& Matrix<T>::operator+=(const Matrix& rhs)
+{
+    CheckSameShape(rhs);
+    for (size_t i = 0; i < rows_; ++i)
+    {
+        T* out = RowData(i);
+        const T* in = rhs.RowData(i);
+        for (size_t j = 0; j < cols_; ++j)
+        {
+            out[j] += in[j];
+        }
+    }
+    return *this;
+}
+
+template<typename T>
+inline Matrix<T>& Matrix<T>::operator-=(const Matrix& rhs)
+{
+    CheckSameShape(rhs);
+    for (size_t i = 0; i < rows_; ++i)
+    {
+        T* out = RowData(i);
+        const T* in = rhs.RowData(i);
+        for (size_t j = 0; j < cols_; ++j)
+        {
+            out[j] -= in[j];
+        }
+    }
+    return *this;
+}
+
+template<typename T>
+inline Matrix<T>& Matrix<T>::operator*=(const T& scalar)
+{
+    for (size_t i = 0; i < rows_; ++i)
+    {
+        T* out = RowData(i);
+        for (size_t j = 0; j < cols_; ++j)
+        {
+            out[j] *= scalar;
+        }
+    }
+    return *this;
+}
+
+template<typename T>
+inline T& Matrix<T>::operator()(size_t row, size_t col) noexcept
+{
+    assert(row < rows_ && col < cols_);
+    return data_[row * stride_ + col];
+}
+
+template<typename T>
+inline const T& Matrix<T>::operator()(size_t row, size_t col) const noexcept
+{
+    assert(row < rows_ && col < cols_);
+    return data_[row * stride_ + col];
+}
+
+template <typename T>
+Matrix<T> operator+(Matrix<T> lhs, const Matrix<T>& rhs)
+{
+    return lhs += rhs;
+}
+
+template <typename T>
+Matrix<T> operator-(Matrix<T> lhs, const Matrix<T>& rhs)
+{
+    return lhs -= rhs;
+}
+
+// Tiled GEMM: c += a * b over blocks small enough to stay in L1/L2. The inner
+// loop walks a row of b and a row of c, both contiguous, so it vectorizes.
+template <typename T>
+void MultiplyAdd(MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> c)
+{
+    if (a.Cols() != b.Rows() || c.Rows() != a.Rows() || c.Cols() != b.Cols())
+    {
+        throw std::invalid_argument("Matrix shapes do not match for multiplication");
+    }
+    const size_t kTileRows = 64;
+    const size_t kTileDepth = 128;
+    const size_t kTileCols = 256;
+    for (size_t ii = 0; ii < a.Rows(); ii += kTileRows)
+    {
+        const size_t i_end = std::min(ii + kTileRows, a.Rows());
+        for (size_t kk = 0; kk < a.Cols(); kk += kTileDepth)
+        {
+            const size_t k_end = std::min(kk + kTileDepth, a.Cols());
+            for (size_t jj = 0; jj < b.Cols(); jj += kTileCols)
+            {
+                const size_t j_end = std::min(jj + kTileCols, b.Cols());
+                for (size_t i = ii; i < i_end; ++i)
+                {
+                    T* out = c.RowData(i);
+                    const T* a_row = a.RowData(i);
+                    for (size_t k = kk; k < k_end; ++k)
+                    {
+                        const T scale = a_row[k];
+                        const T* b_row = b.RowData(k);
+                        for (size_t j = jj; j < j_end; ++j)
+                        {
+                            out[j] += scale * b_row[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+Matrix<T> operator*(const Matrix<T>& lhs, const Matrix<T>& rhs)
+{
+    Matrix<T> result(lhs.Rows(), rhs.Cols());
+    MultiplyAdd(lhs.View(), rhs.View(), result.View());
+    return result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+enum class AllocStatus
+{
+    kOk,
+    kBudgetExceeded,
+    kOutOfMemory,
+};
+
+// Byte budget shared by any number of containers (one container, or every
+// container of a subsystem acting as an arena). Buffers are charged when they
+// are allocated and released when they are freed.
+class MemoryBudget
+{
+public:
+    explicit MemoryBudget(size_t limit) noexcept;
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    bool TryCharge(size_t bytes) noexcept;
+    // Charges even past the limit; used when a buffer that already exists is attached.
+    void Charge(size_t bytes) noexcept;
+    void Release(size_t bytes) noexcept;
+
+    void SetLimit(size_t limit) noexcept;
+    size_t Limit() const noexcept;
+    size_t Used() const noexcept;
+
+private:
+    std::atomic<size_t> limit_;
+    std::atomic<size_t> used_{ 0 };
+};
+
+// Called whenever a budgeted or Try* allocation fails. If it returns true
+// (for example after dropping caches) the allocation is retried once.
+using MemoryPressureHook = bool (*)(size_t requested_bytes, AllocStatus status);
+
+inline std::atomic<MemoryPressureHook> memory_pressure_hook{ nullptr };
+
+inline void SetMemoryPressureHook(MemoryPressureHook hook) noexcept
+{
+    memory_pressure_hook.store(hook, std::memory_order_release);
+}
+
+inline bool NotifyMemoryPressure(size_t requested_bytes, AllocStatus status) noexcept
+{
+    MemoryPressureHook hook = memory_pressure_hook.load(std::memory_order_acquire);
+    return hook != nullptr && hook(requested_bytes, status);
+}
+
+//------------MemoryBudget----------------
+
+inline MemoryBudget::MemoryBudget(size_t limit) noexcept
+    : limit_(limit)
+{}
+
+inline bool MemoryBudget::TryCharge(size_t bytes) noexcept
+{
+    const size_t limit = limit_.load(std::memory_order_relaxed);
+    size_t used = used_.load(std::memory_order_relaxed);
+    do
+    {
+        if (used > limit || bytes > limit - used)
+        {
+            return false;
+        }
+    } while (!used_.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+    return true;
+}
+
+inline void MemoryBudget::Charge(size_t bytes) noexcept
+{
+    used_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline void MemoryBudget::Release(size_t bytes) noexcept
+{
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+inline void MemoryBudget::SetLimit(size_t limit) noexcept
+{
+    limit_.store(limit, std::memory_order_relaxed);
+}
+
+inline size_t MemoryBudget::Limit() const noexcept
+{
+    return limit_.load(std::memory_order_relaxed);
+}
+
+inline size_t MemoryBudget::Used() const noexcept
+{
+    return used_.load(std::memory_order_relaxed);
+}
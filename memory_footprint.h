@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+
+struct Footprint
+{
+    size_t used_bytes = 0;
+    size_t reserved_bytes = 0;
+    size_t slack_bytes = 0;
+
+    Footprint& operator+=(const Footprint& rhs) noexcept;
+};
+
+// Containers that own heap memory specialize this trait so that an enclosing
+// Vector can count the memory held by its elements as well as its own buffer.
+template <typename T>
+struct FootprintTraits
+{
+    static constexpr bool has_nested = false;
+
+    static Footprint Nested(const T&) noexcept
+    {
+        return {};
+    }
+};
+
+inline Footprint& Footprint::operator+=(const Footprint& rhs) noexcept
+{
+    used_bytes += rhs.used_bytes;
+    reserved_bytes += rhs.reserved_bytes;
+    slack_bytes += rhs.slack_bytes;
+    return *this;
+}
+
+inline Footprint operator+(Footprint lhs, const Footprint& rhs) noexcept
+{
+    return lhs += rhs;
+}
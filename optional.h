@@ -2,6 +2,8 @@
 #include <stdexcept>
 #include <utility>
 
+#include "memory_footprint.h"
+
 using namespace std::literals;
 
 class BadOptionalAccess : public std::exception
@@ -284,3 +286,14 @@ inline void Optional<T>::Emplace(Args && ...args)
     value_ = new(&buf_[0]) T(std::forward<Args>(args) ...);
     is_initialized_ = true;
 }
+
+template <typename T>
+struct FootprintTraits<Optional<T>>
+{
+    static constexpr bool has_nested = FootprintTraits<T>::has_nested;
+
+    static Footprint Nested(const Optional<T>& value) noexcept
+    {
+        return value.HasValue() ? FootprintTraits<T>::Nested(*value) : Footprint{};
+    }
+};
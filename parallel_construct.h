@@ -0,0 +1,293 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#define VECTOR_HAS_NUMA_SYSCALLS 1
+#endif
+
+#include "vector.h"
+
+// Where the pages of a parallel-built buffer end up on a NUMA machine.
+//  kFirstTouch - each worker touches its own contiguous slice first, so a slice
+//                lives on the node its worker ran on. Suits later parallel
+//                scans that split the range the same way.
+//  kInterleave - pages are interleaved round robin over all online nodes, for
+//                buffers read from everywhere. Falls back to first touch where
+//                the kernel has no NUMA policy support.
+enum class PagePlacement
+{
+    kFirstTouch,
+    kInterleave,
+};
+
+struct ParallelInit
+{
+    size_t threads = std::thread::hardware_concurrency();
+    PagePlacement placement = PagePlacement::kFirstTouch;
+    // Smaller buffers are built on the calling thread.
+    size_t min_parallel_bytes = size_t(4) << 20;
+};
+
+// A Vector of size value-initialized elements, constructed by options.threads
+// workers. If an element constructor throws, the elements built so far are
+// destroyed and the first exception is rethrown.
+template <typename T>
+Vector<T> MakeVectorParallel(size_t size, const ParallelInit& options = {});
+
+// Copy of source built like MakeVectorParallel; charged to source's budget.
+template <typename T>
+Vector<T> CopyParallel(const Vector<T>& source, const ParallelInit& options = {});
+
+// Destroys the elements on options.threads workers and frees the buffer.
+template <typename T>
+void DestroyParallel(Vector<T>& values, const ParallelInit& options = {});
+
+// Resident pages of [data, data + bytes) per NUMA node, indexed by node.
+// Pages that were never touched are not counted; empty where the kernel cannot
+// tell (non-Linux, or move_pages not permitted).
+inline Vector<size_t> PagesPerNode(const void* data, size_t bytes);
+
+namespace parallel_construct_detail
+{
+    inline size_t ChooseThreads(const ParallelInit& options, size_t bytes) noexcept
+    {
+        if (bytes < options.min_parallel_bytes)
+        {
+            return 1;
+        }
+        const size_t kMinChunkBytes = size_t(1) << 20;
+        return std::clamp<size_t>(std::min(options.threads, bytes / kMinChunkBytes), 1, 256);
+    }
+
+    // Runs body(first, last) over `threads` equal slices of [0, count), the
+    // first on the caller. Returns the exception of the lowest failing slice
+    // (or null) together with which slices finished.
+    template <typename Body>
+    std::exception_ptr ForEachSlice(size_t threads, size_t count, Body body, std::vector<char>& done)
+    {
+        done.assign(threads, 0);
+        std::vector<std::exception_ptr> errors(threads);
+        auto run = [&](size_t i) {
+            try
+            {
+                body(count * i / threads, count * (i + 1) / threads);
+                done[i] = 1;
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < threads; ++i)
+        {
+            workers.emplace_back(run, i);
+        }
+        run(0);
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+        for (const std::exception_ptr& error : errors)
+        {
+            if (error)
+            {
+                return error;
+            }
+        }
+        return nullptr;
+    }
+
+    // Fills dest[0, count) with construct(dest, first, last) per slice; on
+    // failure destroys the finished slices and rethrows.
+    template <typename T, typename Construct>
+    size_t BuildSlices(T* dest, size_t count, size_t threads, Construct construct)
+    {
+        std::vector<char> done;
+        const std::exception_ptr error = ForEachSlice(threads, count, [&](size_t first, size_t last) {
+            construct(dest, first, last);
+            }, done);
+        if (error)
+        {
+            for (size_t i = 0; i < threads; ++i)
+            {
+                if (done[i] != 0)
+                {
+                    std::destroy(dest + count * i / threads, dest + count * (i + 1) / threads);
+                }
+            }
+            std::rethrow_exception(error);
+        }
+        return count;
+    }
+
+#ifdef VECTOR_HAS_NUMA_SYSCALLS
+    // Bit n set for every online node n < 64, from /sys/devices/system/node/online
+    // ("0", "0-1", "0-3,6"...). Zero when unknown.
+    inline uint64_t OnlineNodeMask() noexcept
+    {
+        std::FILE* file = std::fopen("/sys/devices/system/node/online", "r");
+        if (file == nullptr)
+        {
+            return 0;
+        }
+        uint64_t mask = 0;
+        unsigned first = 0;
+        while (std::fscanf(file, "%u", &first) == 1)
+        {
+            unsigned last = first;
+            const int separator = std::fgetc(file);
+            if (separator == '-' && std::fscanf(file, "%u", &last) == 1)
+            {
+                std::fgetc(file);
+            }
+            for (unsigned node = first; node <= last && node < 64; ++node)
+            {
+                mask |= uint64_t{ 1 } << node;
+            }
+        }
+        std::fclose(file);
+        return mask;
+    }
+
+    // Sets an interleave policy on the whole pages inside [data, data + bytes),
+    // moving any already resident ones.
+    inline bool Interleave(void* data, size_t bytes) noexcept
+    {
+        constexpr int kMpolInterleave = 3;
+        constexpr unsigned kMpolMfMove = 1u << 1;
+        const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+        const uintptr_t begin = (reinterpret_cast<uintptr_t>(data) + page - 1) & ~(page - 1);
+        const uintptr_t end = (reinterpret_cast<uintptr_t>(data) + bytes) & ~(page - 1);
+        const uint64_t mask = end > begin ? OnlineNodeMask() : 0;
+        if ((mask & (mask - 1)) == 0)
+        {
+            return false;
+        }
+        const unsigned long node_mask = static_cast<unsigned long>(mask);
+        return ::syscall(SYS_mbind, begin, end - begin, kMpolInterleave, &node_mask, 64, kMpolMfMove) == 0;
+    }
+#endif
+
+    template <typename T>
+    void Place(T* data, size_t count, PagePlacement placement) noexcept
+    {
+#ifdef VECTOR_HAS_NUMA_SYSCALLS
+        if (placement == PagePlacement::kInterleave)
+        {
+            Interleave(data, count * sizeof(T));
+        }
+#else
+        (void)data;
+        (void)count;
+        (void)placement;
+#endif
+    }
+}
+
+//----------------------------ParallelConstruct------------------------------------------------
+
+template <typename T>
+inline Vector<T> MakeVectorParallel(size_t size, const ParallelInit& options)
+{
+    using namespace parallel_construct_detail;
+    Vector<T> result;
+    result.Reserve(size);
+    Place(result.Data(), size, options.placement);
+    const size_t threads = ChooseThreads(options, size * sizeof(T));
+    result.AppendInPlace(size, [&](T* dest, size_t count) {
+        return BuildSlices(dest, count, threads, [](T* to, size_t first, size_t last) {
+            std::uninitialized_value_construct(to + first, to + last);
+            });
+        });
+    return result;
+}
+
+template <typename T>
+inline Vector<T> CopyParallel(const Vector<T>& source, const ParallelInit& options)
+{
+    using namespace parallel_construct_detail;
+    Vector<T> result;
+    result.SetBudget(source.Budget());
+    result.Reserve(source.Size());
+    Place(result.Data(), source.Size(), options.placement);
+    const size_t threads = ChooseThreads(options, source.Size() * sizeof(T));
+    const T* from = source.Data();
+    result.AppendInPlace(source.Size(), [&](T* dest, size_t count) {
+        return BuildSlices(dest, count, threads, [from](T* to, size_t first, size_t last) {
+            std::uninitialized_copy(from + first, from + last, to + first);
+            });
+        });
+    return result;
+}
+
+template <typename T>
+inline void DestroyParallel(Vector<T>& values, const ParallelInit& options)
+{
+    using namespace parallel_construct_detail;
+    if constexpr (std::is_trivially_destructible_v<T>)
+    {
+        values.ClearAndTrim();
+    }
+    else
+    {
+        ReleasedBuffer<T> released = values.Release();
+        T* data = released.data;
+        std::vector<char> done;
+        ForEachSlice(ChooseThreads(options, released.size * sizeof(T)), released.size, [data](size_t first, size_t last) {
+            std::destroy(data + first, data + last);
+            }, done);
+        released.deleter(released.data, released.capacity);
+    }
+}
+
+inline Vector<size_t> PagesPerNode(const void* data, size_t bytes)
+{
+    Vector<size_t> nodes;
+#ifdef VECTOR_HAS_NUMA_SYSCALLS
+    const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(data) & ~(page - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(data) + bytes;
+    const size_t kBatch = 4096;
+    std::vector<void*> pages;
+    std::vector<int> status;
+    for (uintptr_t address = begin; address < end;)
+    {
+        pages.clear();
+        for (; address < end && pages.size() < kBatch; address += page)
+        {
+            pages.push_back(reinterpret_cast<void*>(address));
+        }
+        status.assign(pages.size(), -1);
+        if (::syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0)
+        {
+            return Vector<size_t>();
+        }
+        for (const int node : status)
+        {
+            if (node < 0)
+            {
+                continue;
+            }
+            while (nodes.Size() <= static_cast<size_t>(node))
+            {
+                nodes.PushBack(0);
+            }
+            ++nodes[node];
+        }
+    }
+#else
+    (void)data;
+    (void)bytes;
+#endif
+    return nodes;
+}
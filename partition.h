@@ -0,0 +1,517 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vector.h"
+
+namespace partition_detail
+{
+    // Runs body(0) .. body(count - 1) on their own threads; body(0) on the caller.
+    template <typename Body>
+    void RunParallel(size_t count, Body body)
+    {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < count; ++i)
+        {
+            workers.emplace_back(body, i);
+        }
+        body(0);
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    template <typename Key>
+    uint64_t Mix(Key key) noexcept
+    {
+        static_assert(std::is_integral_v<Key>, "partitioning keys must be integral");
+        return static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15u;
+    }
+
+    // Independent of Mix, whose top bits are shared by every key in a partition.
+    template <typename Key>
+    uint64_t Rehash(Key key) noexcept
+    {
+        uint64_t bits = static_cast<uint64_t>(key);
+        bits ^= bits >> 31;
+        return bits * 0xC2B2AE3D27D4EB4Fu;
+    }
+
+    inline size_t PartitionOf(uint64_t mixed, size_t bits) noexcept
+    {
+        return bits == 0 ? 0 : static_cast<size_t>(mixed >> (64 - bits));
+    }
+
+    inline size_t ChooseThreads(size_t threads, size_t size) noexcept
+    {
+        const size_t kMinChunk = 1 << 15;
+        return std::clamp<size_t>(std::min(threads, size / kMinChunk), 1, 256);
+    }
+
+    // Open addressing on a flat array of keys, with each accumulator at the
+    // same index in values_, so a hit is one key probe and one value update.
+    // Free slots hold kFree; a group whose key is kFree itself lives in the
+    // extra value past the last slot.
+    template <typename Key, typename Value>
+    class GroupTable
+    {
+    public:
+        using Group = std::pair<Key, Value>;
+
+        GroupTable();
+
+        GroupTable(const GroupTable&) = delete;
+        GroupTable& operator=(const GroupTable&) = delete;
+
+        ~GroupTable() noexcept;
+
+        size_t Size() const noexcept
+        {
+            return size_;
+        }
+
+        // Folds value into key's group; returns false, changing nothing, when
+        // that would need a group beyond max_groups.
+        template <typename Combine>
+        bool Add(Key key, Value value, Combine& combine, size_t max_groups = std::numeric_limits<size_t>::max());
+
+        // Hands every group to visit(key, accumulator) in slot order, then
+        // empties the table.
+        template <typename Visit>
+        void Drain(Visit visit);
+
+        void Clear() noexcept;
+
+    private:
+        static_assert(std::is_integral_v<Key>, "group keys must be integral");
+        static constexpr Key kFree = std::numeric_limits<Key>::max();
+        static constexpr size_t kInitialBits = 4;
+
+        size_t Home(Key key) const noexcept
+        {
+            return static_cast<size_t>(Rehash(key) >> (64 - bits_));
+        }
+
+        // The miss path of Add: slot is the free slot the probe for key stopped
+        // at, or keys_.Size() for the kFree key.
+        bool Insert(size_t slot, Key key, Value&& value, size_t max_groups);
+        void Grow();
+
+        Vector<Key> keys_;
+        RawMemory<Value> values_;
+        size_t bits_ = kInitialBits;
+        size_t size_ = 0;
+        bool has_free_key_ = false;
+    };
+
+    template <typename Key, typename Value>
+    GroupTable<Key, Value>::GroupTable()
+        : keys_(size_t(1) << kInitialBits)
+        , values_((size_t(1) << kInitialBits) + 1)
+    {
+        std::fill(keys_.begin(), keys_.end(), kFree);
+    }
+
+    template <typename Key, typename Value>
+    GroupTable<Key, Value>::~GroupTable() noexcept
+    {
+        Clear();
+    }
+
+    template <typename Key, typename Value>
+    template <typename Combine>
+    bool GroupTable<Key, Value>::Add(Key key, Value value, Combine& combine, size_t max_groups)
+    {
+        if (key == kFree)
+        {
+            if (!has_free_key_)
+            {
+                return Insert(keys_.Size(), key, std::move(value), max_groups);
+            }
+            combine(values_[keys_.Size()], std::move(value));
+            return true;
+        }
+        const size_t mask = keys_.Size() - 1;
+        for (size_t slot = Home(key);; slot = (slot + 1) & mask)
+        {
+            if (keys_[slot] == key)
+            {
+                combine(values_[slot], std::move(value));
+                return true;
+            }
+            if (keys_[slot] == kFree)
+            {
+                return Insert(slot, key, std::move(value), max_groups);
+            }
+        }
+    }
+
+    template <typename Key, typename Value>
+    bool GroupTable<Key, Value>::Insert(size_t slot, Key key, Value&& value, size_t max_groups)
+    {
+        if (size_ >= max_groups)
+        {
+            return false;
+        }
+        if (slot == keys_.Size())
+        {
+            new (values_ + slot) Value(std::move(value));
+            has_free_key_ = true;
+            ++size_;
+            return true;
+        }
+        // Kept at most a quarter full, so most hits land on the home slot.
+        if ((size_ + 1) * 4 > keys_.Size())
+        {
+            Grow();
+            slot = Home(key);
+            while (keys_[slot] != kFree)
+            {
+                slot = (slot + 1) & (keys_.Size() - 1);
+            }
+        }
+        new (values_ + slot) Value(std::move(value));
+        keys_[slot] = key;
+        ++size_;
+        return true;
+    }
+
+    template <typename Key, typename Value>
+    template <typename Visit>
+    void GroupTable<Key, Value>::Drain(Visit visit)
+    {
+        for (size_t slot = 0; slot < keys_.Size(); ++slot)
+        {
+            if (keys_[slot] != kFree)
+            {
+                visit(keys_[slot], values_[slot]);
+            }
+        }
+        if (has_free_key_)
+        {
+            visit(kFree, values_[keys_.Size()]);
+        }
+        Clear();
+    }
+
+    template <typename Key, typename Value>
+    void GroupTable<Key, Value>::Clear() noexcept
+    {
+        for (size_t slot = 0; slot < keys_.Size(); ++slot)
+        {
+            if (keys_[slot] != kFree)
+            {
+                std::destroy_at(values_ + slot);
+                keys_[slot] = kFree;
+            }
+        }
+        if (has_free_key_)
+        {
+            std::destroy_at(values_ + keys_.Size());
+            has_free_key_ = false;
+        }
+        size_ = 0;
+    }
+
+    template <typename Key, typename Value>
+    void GroupTable<Key, Value>::Grow()
+    {
+        Vector<Key> keys(keys_.Size() * 2);
+        std::fill(keys.begin(), keys.end(), kFree);
+        RawMemory<Value> values(keys.Size() + 1);
+        ++bits_;
+        const size_t mask = keys.Size() - 1;
+        for (size_t from = 0; from < keys_.Size(); ++from)
+        {
+            if (keys_[from] == kFree)
+            {
+                continue;
+            }
+            size_t to = Home(keys_[from]);
+            while (keys[to] != kFree)
+            {
+                to = (to + 1) & mask;
+            }
+            keys[to] = keys_[from];
+            new (values + to) Value(std::move(values_[from]));
+            std::destroy_at(values_ + from);
+        }
+        if (has_free_key_)
+        {
+            new (values + keys.Size()) Value(std::move(values_[keys_.Size()]));
+            std::destroy_at(values_ + keys_.Size());
+        }
+        keys_.Swap(keys);
+        values_.Swap(values);
+    }
+}
+
+// Elements grouped by partition: partition p is items[offsets[p], offsets[p + 1]).
+template <typename T>
+struct PartitionedVector
+{
+    Vector<T> items;
+    Vector<size_t> offsets;
+
+    size_t PartitionCount() const noexcept
+    {
+        return offsets.Size() == 0 ? 0 : offsets.Size() - 1;
+    }
+
+    const T* PartitionBegin(size_t partition) const noexcept
+    {
+        return items.begin() + offsets[partition];
+    }
+
+    const T* PartitionEnd(size_t partition) const noexcept
+    {
+        return items.begin() + offsets[partition + 1];
+    }
+};
+
+// Fewest radix bits that bring an average partition under target_bytes
+// (a share of L2 by default), capped at 12 so the scatter buffers stay in L1/L2.
+inline size_t ChoosePartitionBits(size_t size, size_t element_bytes, size_t target_bytes = size_t(128) << 10) noexcept
+{
+    size_t bits = 0;
+    while (bits < 12 && (size * element_bytes >> bits) > target_bytes)
+    {
+        ++bits;
+    }
+    return bits;
+}
+
+namespace partition_detail
+{
+    // RadixPartition over the rows source[first[t], last[t]), one range per thread.
+    template <typename T, typename KeyOf>
+    PartitionedVector<T> PartitionRanges(const T* source, const std::vector<size_t>& first,
+        const std::vector<size_t>& last, KeyOf& key_of, size_t partition_bits)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "partitioned records are copied bytewise");
+        const size_t threads = first.size();
+        const size_t partitions = size_t(1) << partition_bits;
+        size_t size = 0;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            size += last[t] - first[t];
+        }
+
+        // histogram[t * partitions + p]; becomes the write cursor of thread t in partition p.
+        std::vector<size_t> histogram(threads * partitions, 0);
+        RunParallel(threads, [&](size_t t) {
+            size_t* counts = histogram.data() + t * partitions;
+            for (size_t i = first[t]; i < last[t]; ++i)
+            {
+                ++counts[PartitionOf(Mix(key_of(source[i])), partition_bits)];
+            }
+            });
+
+        PartitionedVector<T> result;
+        result.offsets.Resize(partitions + 1);
+        size_t running = 0;
+        for (size_t p = 0; p < partitions; ++p)
+        {
+            result.offsets[p] = running;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                const size_t count = histogram[t * partitions + p];
+                histogram[t * partitions + p] = running;
+                running += count;
+            }
+        }
+        result.offsets[partitions] = running;
+
+        constexpr size_t kBufferElements = sizeof(T) >= 64 ? 1 : 64 / sizeof(T);
+        result.items.AppendInPlace(size, [&](T* output, size_t count) {
+            RunParallel(threads, [&](size_t t) {
+                size_t* cursors = histogram.data() + t * partitions;
+                RawMemory<T, 64> buffers(partitions * kBufferElements);
+                Vector<uint8_t> fill(partitions);
+                for (size_t i = first[t]; i < last[t]; ++i)
+                {
+                    const size_t p = PartitionOf(Mix(key_of(source[i])), partition_bits);
+                    T* buffer = buffers + p * kBufferElements;
+                    new (buffer + fill[p]) T(source[i]);
+                    if (++fill[p] == kBufferElements)
+                    {
+                        std::memcpy(static_cast<void*>(output + cursors[p]), buffer, sizeof(T) * kBufferElements);
+                        cursors[p] += kBufferElements;
+                        fill[p] = 0;
+                    }
+                }
+                for (size_t p = 0; p < partitions; ++p)
+                {
+                    std::memcpy(static_cast<void*>(output + cursors[p]), buffers + p * kBufferElements, sizeof(T) * fill[p]);
+                }
+                });
+            return count;
+            });
+        return result;
+    }
+}
+
+// Scatters input into 2^partition_bits partitions by the top bits of a hash of
+// key_of(element). A histogram pass sizes every (partition, thread) slot, then
+// each thread scatters its slice through one cache line per partition of
+// write-combining buffer, so the output is written a full line at a time.
+template <typename T, typename KeyOf>
+PartitionedVector<T> RadixPartition(const Vector<T>& input, KeyOf key_of, size_t partition_bits,
+    size_t threads = std::thread::hardware_concurrency())
+{
+    using namespace partition_detail;
+    const size_t size = input.Size();
+    threads = ChooseThreads(threads, size);
+    std::vector<size_t> first(threads);
+    std::vector<size_t> last(threads);
+    for (size_t t = 0; t < threads; ++t)
+    {
+        first[t] = size * t / threads;
+        last[t] = size * (t + 1) / threads;
+    }
+    return PartitionRanges(input.begin(), first, last, key_of, partition_bits);
+}
+
+// Hash aggregation in two tiers. While each thread sees few distinct keys its
+// private table stays in cache and the tables are simply merged. Once a thread
+// outgrows that, the rows no thread has folded in yet are radix partitioned so
+// that every partition's table fits in cache; the groups already built are
+// carried into their partitions, and partitions are aggregated in parallel.
+// combine(accumulator, value) folds a value in, and must also fold one
+// accumulator into another; the first value of a key initializes its
+// accumulator. Result order is unspecified.
+template <typename T, typename KeyOf, typename ValueOf, typename Combine>
+auto GroupByAggregate(const Vector<T>& input, KeyOf key_of, ValueOf value_of, Combine combine,
+    size_t threads = std::thread::hardware_concurrency())
+{
+    using Key = std::decay_t<std::invoke_result_t<KeyOf&, const T&>>;
+    using Value = std::decay_t<std::invoke_result_t<ValueOf&, const T&>>;
+    using Table = partition_detail::GroupTable<Key, Value>;
+    using Group = typename Table::Group;
+    using namespace partition_detail;
+
+    const size_t kMaxDirectGroups = 1 << 14;
+    const size_t size = input.Size();
+    threads = ChooseThreads(threads, size);
+    Vector<Table> direct(threads);
+    // Thread t folded the rows of its slice before stop[t] into direct[t].
+    std::vector<size_t> stop(threads);
+    std::vector<size_t> last(threads);
+    RunParallel(threads, [&](size_t t) {
+        Table& table = direct[t];
+        const T* row = input.begin() + size * t / threads;
+        const T* end = input.begin() + size * (t + 1) / threads;
+        while (row != end && table.Add(key_of(*row), value_of(*row), combine, kMaxDirectGroups))
+        {
+            ++row;
+        }
+        stop[t] = static_cast<size_t>(row - input.begin());
+        last[t] = static_cast<size_t>(end - input.begin());
+        });
+
+    Vector<Group> result;
+    if (stop == last)
+    {
+        for (size_t t = 1; t < threads; ++t)
+        {
+            direct[t].Drain([&](Key key, Value& value) { direct[0].Add(key, std::move(value), combine); });
+        }
+        result.Reserve(direct[0].Size());
+        direct[0].Drain([&](Key key, Value& value) { result.PushBack({ key, std::move(value) }); });
+        return result;
+    }
+
+    size_t remaining = 0;
+    for (size_t t = 0; t < threads; ++t)
+    {
+        remaining += last[t] - stop[t];
+    }
+    const size_t bits = ChoosePartitionBits(remaining, sizeof(T));
+    const PartitionedVector<T> partitioned = PartitionRanges(input.begin(), stop, last, key_of, bits);
+    const size_t partitions = partitioned.PartitionCount();
+    Vector<Vector<Group>> carried(partitions);
+    for (Table& table : direct)
+    {
+        table.Drain([&](Key key, Value& value) { carried[PartitionOf(Mix(key), bits)].PushBack({ key, std::move(value) }); });
+    }
+    direct.ClearAndTrim();
+
+    Vector<Vector<Group>> local(partitions);
+    RunParallel(threads, [&](size_t t) {
+        Table table;
+        for (size_t p = t; p < partitions; p += threads)
+        {
+            for (Group& group : carried[p])
+            {
+                table.Add(group.first, std::move(group.second), combine);
+            }
+            carried[p].ClearAndTrim();
+            for (const T* row = partitioned.PartitionBegin(p); row != partitioned.PartitionEnd(p); ++row)
+            {
+                table.Add(key_of(*row), value_of(*row), combine);
+            }
+            local[p].Reserve(table.Size());
+            table.Drain([&](Key key, Value& value) { local[p].PushBack({ key, std::move(value) }); });
+        }
+        });
+
+    size_t total = 0;
+    for (const auto& groups : local)
+    {
+        total += groups.Size();
+    }
+    result.Reserve(total);
+    for (auto& groups : local)
+    {
+        for (auto& group : groups)
+        {
+            result.PushBack(std::move(group));
+        }
+    }
+    return result;
+}
+
+template <typename T, typename KeyOf, typename ValueOf>
+auto GroupBySum(const Vector<T>& input, KeyOf key_of, ValueOf value_of, size_t threads = std::thread::hardware_concurrency())
+{
+    return GroupByAggregate(input, key_of, value_of, [](auto& sum, const auto& value) { sum += value; }, threads);
+}
+
+template <typename T, typename KeyOf>
+auto GroupByCount(const Vector<T>& input, KeyOf key_of, size_t threads = std::thread::hardware_concurrency())
+{
+    return GroupByAggregate(input, key_of, [](const T&) { return size_t{ 1 }; },
+        [](size_t& count, size_t one) { count += one; }, threads);
+}
+
+template <typename T, typename KeyOf, typename ValueOf>
+auto GroupByMin(const Vector<T>& input, KeyOf key_of, ValueOf value_of, size_t threads = std::thread::hardware_concurrency())
+{
+    return GroupByAggregate(input, key_of, value_of, [](auto& min, const auto& value) {
+        if (value < min)
+        {
+            min = value;
+        }
+        }, threads);
+}
+
+template <typename T, typename KeyOf, typename ValueOf>
+auto GroupByMax(const Vector<T>& input, KeyOf key_of, ValueOf value_of, size_t threads = std::thread::hardware_concurrency())
+{
+    return GroupByAggregate(input, key_of, value_of, [](auto& max, const auto& value) {
+        if (max < value)
+        {
+            max = value;
+        }
+        }, threads);
+}
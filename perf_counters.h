@@ -0,0 +1,259 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define VECTOR_PERF_EVENTS 1
+#endif
+
+enum class PerfEvent : size_t
+{
+    kCycles,
+    kInstructions,
+    kL1dMisses,
+    kLlcMisses,
+    kBranchMisses,
+    kDtlbMisses,
+};
+
+inline constexpr size_t kPerfEventCount = 6;
+
+inline constexpr std::string_view PerfEventName(PerfEvent event) noexcept
+{
+    constexpr std::string_view kNames[kPerfEventCount] = {
+        "cycles", "instructions", "L1d misses", "LLC misses", "branch misses", "dTLB misses"
+    };
+    return kNames[static_cast<size_t>(event)];
+}
+
+// Counter values from one Start()/Stop() window. Counters the kernel or the
+// hardware would not provide are marked unavailable rather than reported as 0.
+struct PerfSample
+{
+    std::array<uint64_t, kPerfEventCount> values = {};
+    std::array<bool, kPerfEventCount> available = {};
+
+    bool Has(PerfEvent event) const noexcept
+    {
+        return available[static_cast<size_t>(event)];
+    }
+
+    uint64_t Get(PerfEvent event) const noexcept
+    {
+        return values[static_cast<size_t>(event)];
+    }
+
+    bool Any() const noexcept
+    {
+        for (bool has : available)
+        {
+            if (has)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Hardware counters for the calling thread and every thread it creates after
+// construction, so work handed to worker threads inside a window is counted;
+// user space only. Each event is opened on its own so that one unsupported
+// event does not take the rest down; where perf_event_open is missing or
+// forbidden every event is unavailable and Start()/Stop() are no-ops.
+class PerfCounters
+{
+public:
+    PerfCounters() noexcept;
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() noexcept;
+
+    bool Available() const noexcept;
+
+    void Start() noexcept;
+    PerfSample Stop() noexcept;
+
+private:
+    std::array<int, kPerfEventCount> fds_;
+};
+
+// Prints "name: cycles/op 1.2, instructions/op 3.4, ..."; with ops == 0 the
+// raw totals are printed instead.
+inline void PrintPerfSample(std::ostream& out, std::string_view name, const PerfSample& sample, uint64_t ops)
+{
+    using namespace std::literals;
+    out << name << ":"sv;
+    if (!sample.Any())
+    {
+        out << " hardware counters unavailable"sv << std::endl;
+        return;
+    }
+    const double divisor = ops == 0 ? 1.0 : static_cast<double>(ops);
+    bool first = true;
+    for (size_t i = 0; i < kPerfEventCount; ++i)
+    {
+        out << (first ? " "sv : ", "sv) << PerfEventName(static_cast<PerfEvent>(i)) << (ops == 0 ? " "sv : "/op "sv);
+        if (sample.available[i])
+        {
+            out << static_cast<double>(sample.values[i]) / divisor;
+        }
+        else
+        {
+            out << "n/a"sv;
+        }
+        first = false;
+    }
+    out << std::endl;
+}
+
+//----------------------------PerfCounters------------------------------------------------
+
+#ifdef VECTOR_PERF_EVENTS
+
+namespace perf_counters_detail
+{
+    inline perf_event_attr MakeAttr(PerfEvent event) noexcept
+    {
+        constexpr uint64_t kReadMiss = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // Threads spawned later get their own copy of the event; reads sum them in.
+        attr.inherit = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch (event)
+        {
+        case PerfEvent::kCycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::kInstructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::kL1dMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | kReadMiss;
+            break;
+        case PerfEvent::kLlcMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | kReadMiss;
+            break;
+        case PerfEvent::kBranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::kDtlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | kReadMiss;
+            break;
+        }
+        return attr;
+    }
+}
+
+inline PerfCounters::PerfCounters() noexcept
+{
+    for (size_t i = 0; i < kPerfEventCount; ++i)
+    {
+        perf_event_attr attr = perf_counters_detail::MakeAttr(static_cast<PerfEvent>(i));
+        fds_[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+}
+
+inline PerfCounters::~PerfCounters() noexcept
+{
+    for (int fd : fds_)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+}
+
+inline bool PerfCounters::Available() const noexcept
+{
+    for (int fd : fds_)
+    {
+        if (fd >= 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void PerfCounters::Start() noexcept
+{
+    for (int fd : fds_)
+    {
+        if (fd >= 0)
+        {
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+inline PerfSample PerfCounters::Stop() noexcept
+{
+    PerfSample sample;
+    for (int fd : fds_)
+    {
+        if (fd >= 0)
+        {
+            ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (size_t i = 0; i < kPerfEventCount; ++i)
+    {
+        // value, time enabled, time running; scaled up when the PMU was multiplexed.
+        uint64_t data[3] = {};
+        if (fds_[i] < 0 || ::read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+        {
+            continue;
+        }
+        sample.values[i] = data[2] < data[1]
+            ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+            : data[0];
+        sample.available[i] = true;
+    }
+    return sample;
+}
+
+#else
+
+inline PerfCounters::PerfCounters() noexcept
+{
+    fds_.fill(-1);
+}
+
+inline PerfCounters::~PerfCounters() noexcept
+{}
+
+inline bool PerfCounters::Available() const noexcept
+{
+    return false;
+}
+
+inline void PerfCounters::Start() noexcept
+{}
+
+inline PerfSample PerfCounters::Stop() noexcept
+{
+    return {};
+}
+
+#endif
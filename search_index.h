@@ -0,0 +1,198 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <xmmintrin.h>
+#endif
+
+#include "memory_footprint.h"
+#include "vector.h"
+
+// Read-only copy of a sorted Vector in Eytzinger (BFS) order: node k has its
+// children at 2k and 2k+1, so the first levels of every search share a few hot
+// cache lines and the nodes four levels below k are contiguous, which lets
+// the search prefetch them one cache line ahead.
+//
+// Positions returned are those std::lower_bound would give on the source.
+template <typename T, typename Compare = std::less<T>>
+class SearchIndex
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SearchIndex keeps raw copies of the keys");
+
+public:
+    static constexpr size_t kAlignment = 64;
+
+    SearchIndex() = default;
+    explicit SearchIndex(const Vector<T>& sorted, Compare compare = {});
+
+    size_t Size() const noexcept;
+
+    // Index in the source of the first element not less than key, or Size().
+    size_t LowerBound(const T& key) const noexcept;
+
+    // Same for every key, with several searches kept in flight at once so that
+    // their cache misses overlap. out is resized to keys.Size().
+    void LowerBoundMany(const Vector<T>& keys, Vector<size_t>& out) const;
+
+    Footprint MemoryFootprint() const noexcept;
+
+private:
+    static constexpr size_t kLanes = 16;
+    static constexpr size_t kPrefetchStride = kAlignment / sizeof(T) > 0 ? kAlignment / sizeof(T) : 1;
+
+    size_t Fill(const Vector<T>& sorted, size_t node, size_t next) noexcept;
+    size_t Step(size_t node, const T& key) const noexcept;
+    void Prefetch(size_t node) const noexcept;
+    size_t Finish(size_t node) const noexcept;
+
+    static size_t TrailingOnes(size_t value) noexcept;
+
+    // Slot 0 is unused so that node k sits at offset k of a cache-aligned buffer.
+    RawMemory<T, kAlignment> tree_;
+    RawMemory<size_t> ranks_;
+    size_t size_ = 0;
+    size_t full_levels_ = 0;
+    Compare compare_;
+};
+
+//----------------------------SearchIndex------------------------------------------------
+
+template<typename T, typename Compare>
+inline SearchIndex<T, Compare>::SearchIndex(const Vector<T>& sorted, Compare compare)
+    : tree_(sorted.Size() + 1)
+    , ranks_(sorted.Size() + 1)
+    , size_(sorted.Size())
+    , compare_(std::move(compare))
+{
+    assert(std::is_sorted(sorted.begin(), sorted.end(), compare_));
+    Fill(sorted, 1, 0);
+    // Levels that are present for every search path; only the last may be partial.
+    while ((size_t(2) << full_levels_) - 1 <= size_)
+    {
+        ++full_levels_;
+    }
+}
+
+template<typename T, typename Compare>
+inline size_t SearchIndex<T, Compare>::Size() const noexcept
+{
+    return size_;
+}
+
+template<typename T, typename Compare>
+inline size_t SearchIndex<T, Compare>::LowerBound(const T& key) const noexcept
+{
+    size_t node = 1;
+    while (node <= size_)
+    {
+        Prefetch(node);
+        node = Step(node, key);
+    }
+    return Finish(node);
+}
+
+template<typename T, typename Compare>
+inline void SearchIndex<T, Compare>::LowerBoundMany(const Vector<T>& keys, Vector<size_t>& out) const
+{
+    out.Resize(keys.Size());
+    size_t nodes[kLanes];
+    for (size_t base = 0; base < keys.Size(); base += kLanes)
+    {
+        const size_t lanes = std::min(kLanes, keys.Size() - base);
+        const T* batch = keys.begin() + base;
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            nodes[lane] = 1;
+        }
+        // Every path runs through the full levels, so the lanes can advance
+        // in lockstep without bounds checks.
+        for (size_t level = 0; level < full_levels_; ++level)
+        {
+            for (size_t lane = 0; lane < lanes; ++lane)
+            {
+                Prefetch(nodes[lane]);
+                nodes[lane] = Step(nodes[lane], batch[lane]);
+            }
+        }
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            size_t node = nodes[lane];
+            if (node <= size_)
+            {
+                node = Step(node, batch[lane]);
+            }
+            out[base + lane] = Finish(node);
+        }
+    }
+}
+
+template<typename T, typename Compare>
+inline Footprint SearchIndex<T, Compare>::MemoryFootprint() const noexcept
+{
+    Footprint result;
+    result.used_bytes = size_ * (sizeof(T) + sizeof(size_t));
+    result.reserved_bytes = tree_.Capacity() * sizeof(T) + ranks_.Capacity() * sizeof(size_t);
+    result.slack_bytes = result.reserved_bytes - result.used_bytes;
+    return result;
+}
+
+template<typename T, typename Compare>
+inline size_t SearchIndex<T, Compare>::Fill(const Vector<T>& sorted, size_t node, size_t next) noexcept
+{
+    // In-order walk of the implicit tree hands out the sorted elements.
+    if (node <= size_)
+    {
+        next = Fill(sorted, 2 * node, next);
+        tree_[node] = sorted[next];
+        ranks_[node] = next++;
+        next = Fill(sorted, 2 * node + 1, next);
+    }
+    return next;
+}
+
+template<typename T, typename Compare>
+inline size_t SearchIndex<T, Compare>::Step(size_t node, const T& key) const noexcept
+{
+    return 2 * node + static_cast<size_t>(compare_(tree_[node], key));
+}
+
+template<typename T, typename Compare>
+inline void SearchIndex<T, Compare>::Prefetch(size_t node) const noexcept
+{
+    // Integer arithmetic: the target may lie past the end of the tree.
+    const auto address = reinterpret_cast<const char*>(
+        reinterpret_cast<uintptr_t>(tree_.GetAddress()) + node * kPrefetchStride * sizeof(T));
+#if defined(_MSC_VER)
+    _mm_prefetch(address, _MM_HINT_T0);
+#else
+    __builtin_prefetch(address);
+#endif
+}
+
+template<typename T, typename Compare>
+inline size_t SearchIndex<T, Compare>::Finish(size_t node) const noexcept
+{
+    // Undo the trailing right turns plus the last left turn: that left turn
+    // was taken at the answer.
+    node >>= TrailingOnes(node) + 1;
+    return node == 0 ? size_ : ranks_[node];
+}
+
+template<typename T, typename Compare>
+inline size_t SearchIndex<T, Compare>::TrailingOnes(size_t value) noexcept
+{
+    const size_t inverted = ~value;
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward64(&index, inverted);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctzll(inverted));
+#endif
+}
@@ -0,0 +1,233 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "concurrent_queue.h"
+#include "vector.h"
+
+enum class MergeOrder
+{
+    kOrdered,    // shard 0 first, then shard 1, ...
+    kUnordered,  // any order; lets the merge reuse a shard buffer and balance work
+};
+
+// One Vector per producer thread, padded to its own cache lines. Thread i
+// appends to Shard(i) without any synchronization; MergeInto then gathers all
+// shards into a single vector once the producers are done.
+template <typename T>
+class ShardedCollector
+{
+public:
+    explicit ShardedCollector(size_t shards);
+
+    size_t ShardCount() const noexcept;
+
+    Vector<T>& Shard(size_t index) noexcept;
+    const Vector<T>& Shard(size_t index) const noexcept;
+
+    size_t Size() const noexcept;
+
+    // Appends every collected element to out and empties the shards. Offsets
+    // come from a prefix sum over shard sizes, out grows once, and shards are
+    // relocated into place by up to `threads` workers. If relocating an element
+    // throws, out keeps its previous contents and the exception propagates.
+    void MergeInto(Vector<T>& out, MergeOrder order = MergeOrder::kOrdered,
+        size_t threads = std::thread::hardware_concurrency());
+
+    void Clear() noexcept;
+
+private:
+    struct alignas(kCacheLineSize) PaddedShard
+    {
+        Vector<T> items;
+    };
+
+    static void RelocateShard(Vector<T>& from, T* to);
+
+    Vector<PaddedShard> shards_;
+};
+
+//----------------------------ShardedCollector------------------------------------------------
+
+template<typename T>
+inline ShardedCollector<T>::ShardedCollector(size_t shards)
+    : shards_(shards)
+{}
+
+template<typename T>
+inline size_t ShardedCollector<T>::ShardCount() const noexcept
+{
+    return shards_.Size();
+}
+
+template<typename T>
+inline Vector<T>& ShardedCollector<T>::Shard(size_t index) noexcept
+{
+    return shards_[index].items;
+}
+
+template<typename T>
+inline const Vector<T>& ShardedCollector<T>::Shard(size_t index) const noexcept
+{
+    return shards_[index].items;
+}
+
+template<typename T>
+inline size_t ShardedCollector<T>::Size() const noexcept
+{
+    size_t total = 0;
+    for (const PaddedShard& shard : shards_)
+    {
+        total += shard.items.Size();
+    }
+    return total;
+}
+
+template<typename T>
+inline void ShardedCollector<T>::MergeInto(Vector<T>& out, MergeOrder order, size_t threads)
+{
+    const size_t total = Size();
+    if (total == 0)
+    {
+        return;
+    }
+
+    std::vector<size_t> sequence(shards_.Size());
+    Vector<T>* adopted = nullptr;
+    for (size_t i = 0; i < sequence.size(); ++i)
+    {
+        sequence[i] = i;
+    }
+    if (order == MergeOrder::kUnordered)
+    {
+        // Largest shards first so that the last worker to finish has the least left.
+        std::stable_sort(sequence.begin(), sequence.end(), [this](size_t lhs, size_t rhs) {
+            return shards_[lhs].items.Size() > shards_[rhs].items.Size();
+            });
+        // An empty target can simply take over a shard that already has room for everything.
+        if (out.Size() == 0)
+        {
+            for (size_t i = 0; i < sequence.size(); ++i)
+            {
+                if (shards_[sequence[i]].items.Capacity() >= total)
+                {
+                    adopted = &shards_[sequence[i]].items;
+                    out.Swap(*adopted);
+                    sequence.erase(sequence.begin() + i);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<size_t> offsets(sequence.size());
+    size_t running = 0;
+    for (size_t i = 0; i < sequence.size(); ++i)
+    {
+        offsets[i] = running;
+        running += shards_[sequence[i]].items.Size();
+    }
+    if (running == 0)
+    {
+        return;
+    }
+
+    const auto relocate_all = [&](T* dest, size_t count) {
+        const size_t kMinElementsPerThread = 1 << 14;
+        threads = std::clamp<size_t>(std::min({ threads, sequence.size(), count / kMinElementsPerThread }), 1, 256);
+        std::vector<char> done(sequence.size(), 0);
+        std::atomic<size_t> next{ 0 };
+        std::exception_ptr error;
+        std::atomic<bool> failed{ false };
+        const auto work = [&]() {
+            for (size_t i = next.fetch_add(1); i < sequence.size() && !failed.load(); i = next.fetch_add(1))
+            {
+                try
+                {
+                    RelocateShard(shards_[sequence[i]].items, dest + offsets[i]);
+                    done[i] = 1;
+                }
+                catch (...)
+                {
+                    if (!failed.exchange(true))
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+        if (threads == 1)
+        {
+            work();
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < threads; ++i)
+            {
+                workers.emplace_back(work);
+            }
+            work();
+            for (std::thread& worker : workers)
+            {
+                worker.join();
+            }
+        }
+        if (error)
+        {
+            for (size_t i = 0; i < sequence.size(); ++i)
+            {
+                if (done[i])
+                {
+                    std::destroy_n(dest + offsets[i], shards_[sequence[i]].items.Size());
+                }
+            }
+            std::rethrow_exception(error);
+        }
+        return count;
+    };
+    try
+    {
+        out.AppendInPlace(running, relocate_all);
+    }
+    catch (...)
+    {
+        if (adopted != nullptr)
+        {
+            out.Swap(*adopted);
+        }
+        throw;
+    }
+
+    for (size_t index : sequence)
+    {
+        shards_[index].items.Clear();
+    }
+}
+
+template<typename T>
+inline void ShardedCollector<T>::Clear() noexcept
+{
+    for (PaddedShard& shard : shards_)
+    {
+        shard.items.Clear();
+    }
+}
+
+template<typename T>
+inline void ShardedCollector<T>::RelocateShard(Vector<T>& from, T* to)
+{
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+    {
+        std::uninitialized_move_n(from.begin(), from.Size(), to);
+    }
+    else
+    {
+        std::uninitialized_copy_n(from.begin(), from.Size(), to);
+    }
+}
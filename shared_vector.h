@@ -0,0 +1,488 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VECTOR_HAS_SHARED_MEMORY 1
+#endif
+
+#include "vector.h"
+
+#ifdef VECTOR_HAS_SHARED_MEMORY
+
+// Segment header; everything else in the segment is located by offset from
+// the start of the segment, so each process may map it at its own address.
+struct SharedVectorHeader
+{
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the seqlock must work across processes");
+
+    static constexpr uint64_t kMagic = 0x5653484d56454331;  // "VSHMVEC1"
+
+    uint64_t magic;
+    uint64_t element_size;
+    uint64_t data_offset;
+    std::atomic<uint64_t> sequence;  // odd while the writer is mid-update
+    std::atomic<uint64_t> size;
+    std::atomic<uint64_t> capacity;
+};
+
+// A Vector of trivially copyable T in a POSIX shared memory segment (shm_open,
+// or memfd_create on Linux). One process owns the writer side; any number of
+// processes open readers. Updates are published through a seqlock: readers
+// copy elements out and retry if the writer touched the segment meanwhile, so
+// they never block the writer. Growth extends the segment in place and readers
+// remap it lazily when they see the larger capacity.
+//
+// As with any seqlock, readers may copy bytes while they are being written;
+// such copies are detected and discarded, never returned.
+// A SharedVector object itself is not thread-safe; give each thread its own.
+template <typename T>
+class SharedVector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "shared elements must be trivially copyable");
+
+public:
+    // Creates the named segment; fails if it already exists.
+    static SharedVector Create(const std::string& name, size_t capacity);
+    static SharedVector Open(const std::string& name);
+    static void Unlink(const std::string& name) noexcept;
+
+#ifdef __linux__
+    // Unnamed segment; share Fd() with child processes or over a unix socket.
+    static SharedVector CreateAnonymous(size_t capacity);
+#endif
+    // Opens a reader over a segment descriptor; the descriptor is duplicated.
+    static SharedVector OpenFd(int fd);
+
+    SharedVector(const SharedVector&) = delete;
+    SharedVector& operator=(const SharedVector&) = delete;
+
+    SharedVector(SharedVector&& other) noexcept;
+    SharedVector& operator=(SharedVector&& rhs) noexcept;
+
+    ~SharedVector() noexcept;
+
+    int Fd() const noexcept;
+    bool IsWriter() const noexcept;
+
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+
+    // Consistent copy of one element / of all published elements.
+    T Get(size_t index) const;
+    Vector<T> Snapshot() const;
+
+    // Writer side. Each call is one atomic publication for readers.
+    void Reserve(size_t capacity);
+    void PushBack(const T& value);
+    template <typename InputIt>
+    void Append(InputIt first, InputIt last);
+    void Set(size_t index, const T& value);
+    void Clear();
+
+private:
+    SharedVector(int fd, bool writer);
+
+    static size_t DataOffset() noexcept;
+    static size_t SegmentBytes(size_t capacity) noexcept;
+    [[noreturn]] static void Fail(const char* what);
+
+    SharedVectorHeader& Header() const noexcept;
+    T* Data() const noexcept;
+
+    void Map(size_t bytes) const;
+    void EnsureMapped(size_t capacity) const;
+    void CheckWriter() const;
+    void BeginWrite() noexcept;
+    void EndWrite() noexcept;
+    void InitializeHeader(size_t capacity);
+
+    int fd_ = -1;
+    bool writer_ = false;
+    mutable char* base_ = nullptr;
+    mutable size_t mapped_bytes_ = 0;
+};
+
+//----------------------------SharedVector------------------------------------------------
+//------Costructer and destructor-----
+
+template<typename T>
+inline SharedVector<T>::SharedVector(int fd, bool writer)
+    : fd_(fd)
+    , writer_(writer)
+{}
+
+template<typename T>
+inline SharedVector<T> SharedVector<T>::Create(const std::string& name, size_t capacity)
+{
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+        Fail("shm_open");
+    }
+    SharedVector result(fd, true);
+    try
+    {
+        result.InitializeHeader(capacity);
+    }
+    catch (...)
+    {
+        ::shm_unlink(name.c_str());
+        throw;
+    }
+    return result;
+}
+
+template<typename T>
+inline SharedVector<T> SharedVector<T>::Open(const std::string& name)
+{
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        Fail("shm_open");
+    }
+    SharedVector result(fd, false);
+    result.EnsureMapped(0);
+    return result;
+}
+
+template<typename T>
+inline void SharedVector<T>::Unlink(const std::string& name) noexcept
+{
+    ::shm_unlink(name.c_str());
+}
+
+#ifdef __linux__
+template<typename T>
+inline SharedVector<T> SharedVector<T>::CreateAnonymous(size_t capacity)
+{
+    const int fd = ::memfd_create("SharedVector", 0);
+    if (fd < 0)
+    {
+        Fail("memfd_create");
+    }
+    SharedVector result(fd, true);
+    result.InitializeHeader(capacity);
+    return result;
+}
+#endif
+
+template<typename T>
+inline SharedVector<T> SharedVector<T>::OpenFd(int fd)
+{
+    const int copy = ::dup(fd);
+    if (copy < 0)
+    {
+        Fail("dup");
+    }
+    SharedVector result(copy, false);
+    result.EnsureMapped(0);
+    return result;
+}
+
+template<typename T>
+inline SharedVector<T>::SharedVector(SharedVector&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1))
+    , writer_(other.writer_)
+    , base_(std::exchange(other.base_, nullptr))
+    , mapped_bytes_(std::exchange(other.mapped_bytes_, 0))
+{}
+
+template<typename T>
+inline SharedVector<T>& SharedVector<T>::operator=(SharedVector&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        std::swap(fd_, rhs.fd_);
+        std::swap(writer_, rhs.writer_);
+        std::swap(base_, rhs.base_);
+        std::swap(mapped_bytes_, rhs.mapped_bytes_);
+    }
+    return *this;
+}
+
+template<typename T>
+inline SharedVector<T>::~SharedVector() noexcept
+{
+    if (base_ != nullptr)
+    {
+        ::munmap(base_, mapped_bytes_);
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+//------------Methods--------------
+
+template<typename T>
+inline int SharedVector<T>::Fd() const noexcept
+{
+    return fd_;
+}
+
+template<typename T>
+inline bool SharedVector<T>::IsWriter() const noexcept
+{
+    return writer_;
+}
+
+template<typename T>
+inline size_t SharedVector<T>::Size() const noexcept
+{
+    return static_cast<size_t>(Header().size.load(std::memory_order_acquire));
+}
+
+template<typename T>
+inline size_t SharedVector<T>::Capacity() const noexcept
+{
+    return static_cast<size_t>(Header().capacity.load(std::memory_order_acquire));
+}
+
+template<typename T>
+inline T SharedVector<T>::Get(size_t index) const
+{
+    alignas(T) unsigned char bytes[sizeof(T)];
+    for (;;)
+    {
+        const uint64_t before = Header().sequence.load(std::memory_order_acquire);
+        if (before % 2 == 0)
+        {
+            const size_t size = Size();
+            if (index >= size)
+            {
+                throw std::out_of_range("SharedVector index out of range");
+            }
+            EnsureMapped(Capacity());
+            std::memcpy(bytes, Data() + index, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Header().sequence.load(std::memory_order_relaxed) == before)
+            {
+                T value;
+                std::memcpy(&value, bytes, sizeof(T));
+                return value;
+            }
+        }
+    }
+}
+
+template<typename T>
+inline Vector<T> SharedVector<T>::Snapshot() const
+{
+    Vector<T> result;
+    for (;;)
+    {
+        const uint64_t before = Header().sequence.load(std::memory_order_acquire);
+        if (before % 2 != 0)
+        {
+            continue;
+        }
+        const size_t size = Size();
+        EnsureMapped(Capacity());
+        result.Clear();
+        result.AppendInPlace(size, [&](T* dest, size_t count) {
+            std::memcpy(static_cast<void*>(dest), Data(), count * sizeof(T));
+            return count;
+            });
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (Header().sequence.load(std::memory_order_relaxed) == before)
+        {
+            return result;
+        }
+    }
+}
+
+template<typename T>
+inline void SharedVector<T>::Reserve(size_t capacity)
+{
+    CheckWriter();
+    if (capacity <= Capacity())
+    {
+        return;
+    }
+    // The segment only ever grows, so data already published stays valid in
+    // every reader's existing mapping.
+    if (::ftruncate(fd_, static_cast<off_t>(SegmentBytes(capacity))) != 0)
+    {
+        Fail("ftruncate");
+    }
+    Map(SegmentBytes(capacity));
+    BeginWrite();
+    Header().capacity.store(capacity, std::memory_order_release);
+    EndWrite();
+}
+
+template<typename T>
+inline void SharedVector<T>::PushBack(const T& value)
+{
+    Append(&value, &value + 1);
+}
+
+template<typename T>
+template<typename InputIt>
+inline void SharedVector<T>::Append(InputIt first, InputIt last)
+{
+    CheckWriter();
+    const size_t size = Size();
+    const size_t count = static_cast<size_t>(std::distance(first, last));
+    if (size + count > Capacity())
+    {
+        Reserve(std::max(size + count, Capacity() * 2));
+    }
+    // Elements past size are invisible to readers until size moves.
+    T* dest = Data() + size;
+    for (; first != last; ++first, ++dest)
+    {
+        std::memcpy(static_cast<void*>(dest), &*first, sizeof(T));
+    }
+    BeginWrite();
+    Header().size.store(size + count, std::memory_order_release);
+    EndWrite();
+}
+
+template<typename T>
+inline void SharedVector<T>::Set(size_t index, const T& value)
+{
+    CheckWriter();
+    if (index >= Size())
+    {
+        throw std::out_of_range("SharedVector index out of range");
+    }
+    BeginWrite();
+    std::memcpy(static_cast<void*>(Data() + index), &value, sizeof(T));
+    EndWrite();
+}
+
+template<typename T>
+inline void SharedVector<T>::Clear()
+{
+    CheckWriter();
+    BeginWrite();
+    Header().size.store(0, std::memory_order_release);
+    EndWrite();
+}
+
+template<typename T>
+inline size_t SharedVector<T>::DataOffset() noexcept
+{
+    const size_t align = alignof(T) > 64 ? alignof(T) : 64;
+    return (sizeof(SharedVectorHeader) + align - 1) / align * align;
+}
+
+template<typename T>
+inline size_t SharedVector<T>::SegmentBytes(size_t capacity) noexcept
+{
+    return DataOffset() + capacity * sizeof(T);
+}
+
+template<typename T>
+inline void SharedVector<T>::Fail(const char* what)
+{
+    throw std::runtime_error(std::string(what) + " failed: " + std::strerror(errno));
+}
+
+template<typename T>
+inline SharedVectorHeader& SharedVector<T>::Header() const noexcept
+{
+    return *reinterpret_cast<SharedVectorHeader*>(base_);
+}
+
+template<typename T>
+inline T* SharedVector<T>::Data() const noexcept
+{
+    return reinterpret_cast<T*>(base_ + Header().data_offset);
+}
+
+template<typename T>
+inline void SharedVector<T>::Map(size_t bytes) const
+{
+    const int protection = writer_ ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* mapping = ::mmap(nullptr, bytes, protection, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED)
+    {
+        Fail("mmap");
+    }
+    if (base_ != nullptr)
+    {
+        ::munmap(base_, mapped_bytes_);
+    }
+    base_ = static_cast<char*>(mapping);
+    mapped_bytes_ = bytes;
+}
+
+template<typename T>
+inline void SharedVector<T>::EnsureMapped(size_t capacity) const
+{
+    if (base_ != nullptr && SegmentBytes(capacity) <= mapped_bytes_)
+    {
+        return;
+    }
+    struct stat info;
+    if (::fstat(fd_, &info) != 0)
+    {
+        Fail("fstat");
+    }
+    const size_t bytes = static_cast<size_t>(info.st_size);
+    if (bytes < sizeof(SharedVectorHeader))
+    {
+        throw std::runtime_error("shared segment is not initialized");
+    }
+    Map(bytes);
+    if (Header().magic != SharedVectorHeader::kMagic || Header().element_size != sizeof(T))
+    {
+        throw std::runtime_error("not a SharedVector segment of this element type");
+    }
+}
+
+template<typename T>
+inline void SharedVector<T>::CheckWriter() const
+{
+    if (!writer_)
+    {
+        throw std::logic_error("SharedVector opened read-only");
+    }
+}
+
+template<typename T>
+inline void SharedVector<T>::BeginWrite() noexcept
+{
+    Header().sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+template<typename T>
+inline void SharedVector<T>::EndWrite() noexcept
+{
+    Header().sequence.fetch_add(1, std::memory_order_release);
+}
+
+template<typename T>
+inline void SharedVector<T>::InitializeHeader(size_t capacity)
+{
+    if (::ftruncate(fd_, static_cast<off_t>(SegmentBytes(capacity))) != 0)
+    {
+        Fail("ftruncate");
+    }
+    Map(SegmentBytes(capacity));
+    SharedVectorHeader* header = new (base_) SharedVectorHeader{};
+    header->element_size = sizeof(T);
+    header->data_offset = DataOffset();
+    header->capacity.store(capacity, std::memory_order_relaxed);
+    header->magic = SharedVectorHeader::kMagic;
+}
+
+#endif
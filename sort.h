@@ -0,0 +1,183 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vector.h"
+
+namespace sort_detail
+{
+    template <typename Key>
+    using UnsignedKey = std::conditional_t<sizeof(Key) <= 4, uint32_t, uint64_t>;
+
+    // Maps a key to an unsigned integer with the same ordering.
+    template <typename Key>
+    UnsignedKey<Key> ToOrderedBits(Key key) noexcept
+    {
+        using Bits = UnsignedKey<Key>;
+        if constexpr (std::is_floating_point_v<Key>)
+        {
+            static_assert(sizeof(Key) == sizeof(Bits), "Unsupported floating point key");
+            Bits bits;
+            std::memcpy(&bits, &key, sizeof(bits));
+            const Bits sign = Bits{ 1 } << (sizeof(Bits) * 8 - 1);
+            return (bits & sign) != 0 ? ~bits : bits | sign;
+        }
+        else if constexpr (std::is_signed_v<Key>)
+        {
+            const Bits sign = Bits{ 1 } << (sizeof(Key) * 8 - 1);
+            return static_cast<Bits>(static_cast<std::make_unsigned_t<Key>>(key)) ^ sign;
+        }
+        else
+        {
+            return static_cast<Bits>(key);
+        }
+    }
+
+    template <typename T>
+    void RelocateN(T* from, size_t count, T* to) noexcept
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if (count != 0)
+            {
+                std::memcpy(to, from, count * sizeof(T));
+            }
+        }
+        else
+        {
+            std::uninitialized_move_n(from, count, to);
+            std::destroy_n(from, count);
+        }
+    }
+}
+
+// LSD radix sort on the key returned by key_of, which must be an integral or
+// floating point value. DigitBits is the digit width (8, 11 and 16 are the
+// usual choices). Stable. Passes whose digit is the same for every element
+// are skipped.
+template <size_t DigitBits = 8, typename T, typename KeyOf>
+void RadixSortBy(Vector<T>& values, KeyOf key_of)
+{
+    using Key = std::decay_t<std::invoke_result_t<KeyOf&, const T&>>;
+    static_assert(std::is_integral_v<Key> || std::is_floating_point_v<Key>, "Radix sort needs an integral or floating point key");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "Radix sort relocates elements and needs a noexcept move");
+    static_assert(DigitBits > 0 && DigitBits <= 16, "Digit width must be between 1 and 16 bits");
+
+    using Bits = sort_detail::UnsignedKey<Key>;
+    constexpr size_t kKeyBits = sizeof(Key) * 8;
+    constexpr size_t kPasses = (kKeyBits + DigitBits - 1) / DigitBits;
+    constexpr size_t kBuckets = size_t{ 1 } << DigitBits;
+    constexpr Bits kMask = static_cast<Bits>(kBuckets - 1);
+
+    const size_t size = values.Size();
+    if (size < 2)
+    {
+        return;
+    }
+
+    Vector<size_t> counts(kPasses * kBuckets);
+    for (const T& value : values)
+    {
+        const Bits bits = sort_detail::ToOrderedBits(key_of(value));
+        for (size_t pass = 0; pass < kPasses; ++pass)
+        {
+            ++counts[pass * kBuckets + ((bits >> (pass * DigitBits)) & kMask)];
+        }
+    }
+
+    RawMemory<T> scratch(size);
+    T* from = values.begin();
+    T* to = scratch.GetAddress();
+    for (size_t pass = 0; pass < kPasses; ++pass)
+    {
+        size_t* offsets = counts.begin() + pass * kBuckets;
+        const Bits first_digit = (sort_detail::ToOrderedBits(key_of(from[0])) >> (pass * DigitBits)) & kMask;
+        if (offsets[first_digit] == size)
+        {
+            continue;
+        }
+        size_t total = 0;
+        for (size_t bucket = 0; bucket < kBuckets; ++bucket)
+        {
+            const size_t count = offsets[bucket];
+            offsets[bucket] = total;
+            total += count;
+        }
+        for (size_t i = 0; i < size; ++i)
+        {
+            const Bits digit = (sort_detail::ToOrderedBits(key_of(from[i])) >> (pass * DigitBits)) & kMask;
+            sort_detail::RelocateN(from + i, 1, to + offsets[digit]++);
+        }
+        std::swap(from, to);
+    }
+    if (from != values.begin())
+    {
+        sort_detail::RelocateN(from, size, values.begin());
+    }
+}
+
+template <size_t DigitBits = 8, typename T>
+void RadixSort(Vector<T>& values)
+{
+    RadixSortBy<DigitBits>(values, [](const T& value) { return value; });
+}
+
+// Sorts equal slices on separate threads, then merges neighbouring runs
+// pairwise, each round in parallel, until one run is left.
+template <typename T, typename Compare = std::less<>>
+void ParallelSort(Vector<T>& values, Compare compare = {}, size_t threads = std::thread::hardware_concurrency())
+{
+    const size_t kMinSliceSize = 1 << 14;
+    const size_t size = values.Size();
+    threads = std::clamp<size_t>(std::min(threads, size / kMinSliceSize), 1, 256);
+    if (threads == 1)
+    {
+        std::sort(values.begin(), values.end(), compare);
+        return;
+    }
+
+    std::vector<size_t> bounds(threads + 1);
+    for (size_t i = 0; i <= threads; ++i)
+    {
+        bounds[i] = size * i / threads;
+    }
+    T* data = values.begin();
+    {
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i)
+        {
+            workers.emplace_back([data, &bounds, &compare, i]() {
+                std::sort(data + bounds[i], data + bounds[i + 1], compare);
+                });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+    for (size_t width = 1; width < threads; width *= 2)
+    {
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i + width < threads; i += 2 * width)
+        {
+            const size_t first = bounds[i];
+            const size_t middle = bounds[i + width];
+            const size_t last = bounds[std::min(i + 2 * width, threads)];
+            workers.emplace_back([data, first, middle, last, &compare]() {
+                std::inplace_merge(data + first, data + middle, data + last, compare);
+                });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+}
@@ -0,0 +1,470 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "memory_footprint.h"
+
+enum class OverflowPolicy
+{
+    kChecked,    // exceeding the capacity throws std::length_error
+    kUnchecked,  // exceeding the capacity is a precondition violation (assert)
+};
+
+template <size_t N>
+using StaticSizeType = std::conditional_t<N <= UINT8_MAX, uint8_t,
+    std::conditional_t<N <= UINT16_MAX, uint16_t,
+    std::conditional_t<N <= UINT32_MAX, uint32_t, size_t>>>;
+
+namespace static_vector_detail
+{
+    template <typename T, typename... Args>
+    constexpr T Make(Args&&... args)
+    {
+        if constexpr (std::is_constructible_v<T, Args...>)
+        {
+            return T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            return T{ std::forward<Args>(args)... };
+        }
+    }
+
+    // Trivially copyable and destructible element types live in a plain array,
+    // which keeps the whole container trivially copyable and usable in constant
+    // expressions. C++17 constant evaluation cannot start the lifetime of an
+    // array element by placement new, so there the array is value-initialized
+    // up front and filled by assignment; that is why T must also be default
+    // constructible and assignable (default member initializers are fine). At
+    // run time nothing is initialized until it is constructed.
+    template <typename T>
+    inline constexpr bool kArrayStorage = std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+        && std::is_default_constructible_v<T> && std::is_move_assignable_v<T>;
+
+    struct ValueInitTag
+    {};
+
+    template <typename T, size_t N>
+    union ArrayElements
+    {
+        constexpr ArrayElements() noexcept
+            : none()
+        {}
+
+        constexpr explicit ArrayElements(ValueInitTag)
+            : data()
+        {}
+
+        char none;
+        T data[N];
+    };
+
+    template <typename T, size_t N, typename SizeType, bool InArray = kArrayStorage<T>>
+    struct Storage
+    {
+        constexpr Storage()
+            : elements(__builtin_is_constant_evaluated() ? ArrayElements<T, N>(ValueInitTag{}) : ArrayElements<T, N>())
+        {}
+
+        constexpr T* Data() noexcept
+        {
+            return elements.data;
+        }
+
+        constexpr const T* Data() const noexcept
+        {
+            return elements.data;
+        }
+
+        template <typename... Args>
+        constexpr void ConstructAt(size_t index, Args&&... args)
+        {
+            if (__builtin_is_constant_evaluated())
+            {
+                elements.data[index] = Make<T>(std::forward<Args>(args)...);
+            }
+            else
+            {
+                new(elements.data + index) T(Make<T>(std::forward<Args>(args)...));
+            }
+        }
+
+        constexpr void DestroyAt(size_t) noexcept
+        {}
+
+        ArrayElements<T, N> elements;
+        SizeType size = 0;
+    };
+
+    template <typename T, size_t N, typename SizeType>
+    struct Storage<T, N, SizeType, false>
+    {
+        Storage() = default;
+
+        Storage(const Storage& other)
+        {
+            std::uninitialized_copy_n(other.Data(), other.size, Data());
+            size = other.size;
+        }
+
+        Storage(Storage&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            std::uninitialized_move_n(other.Data(), other.size, Data());
+            size = other.size;
+        }
+
+        Storage& operator=(const Storage& rhs)
+        {
+            if (this != &rhs)
+            {
+                Storage copy(rhs);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        Storage& operator=(Storage&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if (this != &rhs)
+            {
+                std::destroy_n(Data(), size);
+                size = 0;
+                std::uninitialized_move_n(rhs.Data(), rhs.size, Data());
+                size = rhs.size;
+            }
+            return *this;
+        }
+
+        ~Storage()
+        {
+            std::destroy_n(Data(), size);
+        }
+
+        T* Data() noexcept
+        {
+            return std::launder(reinterpret_cast<T*>(bytes));
+        }
+
+        const T* Data() const noexcept
+        {
+            return std::launder(reinterpret_cast<const T*>(bytes));
+        }
+
+        template <typename... Args>
+        void ConstructAt(size_t index, Args&&... args)
+        {
+            if constexpr (std::is_constructible_v<T, Args...>)
+            {
+                new(Data() + index) T(std::forward<Args>(args)...);
+            }
+            else
+            {
+                new(Data() + index) T{ std::forward<Args>(args)... };
+            }
+        }
+
+        void DestroyAt(size_t index) noexcept
+        {
+            std::destroy_at(Data() + index);
+        }
+
+        alignas(T) unsigned char bytes[N * sizeof(T)];
+        SizeType size = 0;
+    };
+}
+
+// Vector with inline storage for at most N elements and no heap allocation.
+// It can be used in constant expressions only when T is trivially copyable,
+// trivially destructible, default constructible and assignable; other element
+// types are constructed in raw storage and work at run time only.
+template <typename T, size_t N, OverflowPolicy Policy = OverflowPolicy::kChecked>
+class StaticVector
+{
+    static_assert(N > 0, "StaticVector needs a non-zero capacity");
+
+public:
+    using size_type = StaticSizeType<N>;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    constexpr StaticVector() = default;
+    constexpr explicit StaticVector(size_t size);
+
+    constexpr iterator begin() noexcept;
+    constexpr iterator end() noexcept;
+    constexpr const_iterator begin() const noexcept;
+    constexpr const_iterator end() const noexcept;
+    constexpr const_iterator cbegin() const noexcept;
+    constexpr const_iterator cend() const noexcept;
+
+    // Only checks that new_capacity fits; the storage is always N elements.
+    constexpr void Reserve(size_t new_capacity);
+
+    constexpr void Resize(size_t size);
+
+    constexpr void PushBack(const T& value);
+
+    constexpr void PushBack(T&& value);
+
+    constexpr void PopBack() noexcept;
+
+    template<typename ... Args>
+    constexpr T& EmplaceBack(Args&&... args);
+
+    template <typename... Args>
+    constexpr iterator Emplace(const_iterator pos, Args&&... args);
+
+    constexpr iterator Erase(const_iterator pos);
+
+    constexpr iterator Insert(const_iterator pos, const T& value);
+
+    constexpr iterator Insert(const_iterator pos, T&& value);
+
+    constexpr void Clear() noexcept;
+
+    constexpr size_t Size() const noexcept;
+
+    constexpr size_t Capacity() const noexcept;
+
+    constexpr bool Full() const noexcept;
+
+    Footprint MemoryFootprint() const noexcept;
+
+    constexpr const T& operator[](size_t index) const noexcept;
+
+    constexpr T& operator[](size_t index) noexcept;
+
+private:
+    constexpr void CheckCapacity(size_t size) const;
+
+    static_vector_detail::Storage<T, N, size_type> storage_;
+};
+
+//------Costructer-----
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr StaticVector<T, N, Policy>::StaticVector(size_t size)
+{
+    Resize(size);
+}
+
+//-----------Iterators--------
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr T* StaticVector<T, N, Policy>::begin() noexcept
+{
+    return storage_.Data();
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr T* StaticVector<T, N, Policy>::end() noexcept
+{
+    return storage_.Data() + storage_.size;
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr const T* StaticVector<T, N, Policy>::begin() const noexcept
+{
+    return storage_.Data();
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr const T* StaticVector<T, N, Policy>::end() const noexcept
+{
+    return storage_.Data() + storage_.size;
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr const T* StaticVector<T, N, Policy>::cbegin() const noexcept
+{
+    return begin();
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr const T* StaticVector<T, N, Policy>::cend() const noexcept
+{
+    return end();
+}
+
+//------------Methods--------------
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr void StaticVector<T, N, Policy>::Reserve(size_t new_capacity)
+{
+    CheckCapacity(new_capacity);
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr void StaticVector<T, N, Policy>::Resize(size_t size)
+{
+    CheckCapacity(size);
+    while (storage_.size > size)
+    {
+        PopBack();
+    }
+    while (storage_.size < size)
+    {
+        storage_.ConstructAt(storage_.size);
+        ++storage_.size;
+    }
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr void StaticVector<T, N, Policy>::PushBack(const T& value)
+{
+    EmplaceBack(value);
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr void StaticVector<T, N, Policy>::PushBack(T&& value)
+{
+    EmplaceBack(std::move(value));
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr void StaticVector<T, N, Policy>::PopBack() noexcept
+{
+    assert(storage_.size != 0);
+    --storage_.size;
+    storage_.DestroyAt(storage_.size);
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+template<typename ...Args>
+inline constexpr T& StaticVector<T, N, Policy>::EmplaceBack(Args && ...args)
+{
+    CheckCapacity(storage_.size + size_t{ 1 });
+    storage_.ConstructAt(storage_.size, std::forward<Args>(args)...);
+    ++storage_.size;
+    return storage_.Data()[storage_.size - 1];
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+template<typename ...Args>
+inline constexpr T* StaticVector<T, N, Policy>::Emplace(const_iterator pos, Args && ...args)
+{
+    const size_t index = static_cast<size_t>(pos - begin());
+    assert(index <= storage_.size);
+    CheckCapacity(storage_.size + size_t{ 1 });
+    if (index == storage_.size)
+    {
+        return &EmplaceBack(std::forward<Args>(args)...);
+    }
+    // Build the value first: args may refer to an element that is about to move.
+    T value = static_vector_detail::Make<T>(std::forward<Args>(args)...);
+    T* data = storage_.Data();
+    storage_.ConstructAt(storage_.size, std::move(data[storage_.size - 1]));
+    for (size_t i = storage_.size - 1; i > index; --i)
+    {
+        data[i] = std::move(data[i - 1]);
+    }
+    data[index] = std::move(value);
+    ++storage_.size;
+    return data + index;
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr T* StaticVector<T, N, Policy>::Erase(const_iterator pos)
+{
+    const size_t index = static_cast<size_t>(pos - begin());
+    assert(index < storage_.size);
+    T* data = storage_.Data();
+    for (size_t i = index + 1; i < storage_.size; ++i)
+    {
+        data[i - 1] = std::move(data[i]);
+    }
+    PopBack();
+    return data + index;
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr T* StaticVector<T, N, Policy>::Insert(const_iterator pos, const T& value)
+{
+    return Emplace(pos, value);
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr T* StaticVector<T, N, Policy>::Insert(const_iterator pos, T&& value)
+{
+    return Emplace(pos, std::move(value));
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr void StaticVector<T, N, Policy>::Clear() noexcept
+{
+    while (storage_.size != 0)
+    {
+        PopBack();
+    }
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr size_t StaticVector<T, N, Policy>::Size() const noexcept
+{
+    return storage_.size;
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr size_t StaticVector<T, N, Policy>::Capacity() const noexcept
+{
+    return N;
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr bool StaticVector<T, N, Policy>::Full() const noexcept
+{
+    return storage_.size == N;
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline Footprint StaticVector<T, N, Policy>::MemoryFootprint() const noexcept
+{
+    // The storage is part of the object itself, so there is nothing on the heap
+    // unless the elements own some.
+    Footprint result;
+    if constexpr (FootprintTraits<T>::has_nested)
+    {
+        for (size_t i = 0; i < Size(); ++i)
+        {
+            result += FootprintTraits<T>::Nested((*this)[i]);
+        }
+    }
+    return result;
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr void StaticVector<T, N, Policy>::CheckCapacity(size_t size) const
+{
+    if constexpr (Policy == OverflowPolicy::kChecked)
+    {
+        if (size > N)
+        {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+    else
+    {
+        assert(size <= N);
+    }
+}
+
+//------------Operators-------------
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr const T& StaticVector<T, N, Policy>::operator[](size_t index) const noexcept
+{
+    assert(index < storage_.size);
+    return storage_.Data()[index];
+}
+
+template<typename T, size_t N, OverflowPolicy Policy>
+inline constexpr T& StaticVector<T, N, Policy>::operator[](size_t index) noexcept
+{
+    assert(index < storage_.size);
+    return storage_.Data()[index];
+}
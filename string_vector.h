@@ -0,0 +1,233 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "memory_footprint.h"
+#include "vector.h"
+
+// Strings packed back to back into one growable byte blob. Element i is the
+// range [offsets_[i], offsets_[i + 1]) of the blob; the last offset is the end
+// of the blob, and it is pushed together with the first string. Since lengths
+// are differences of neighbouring offsets, the blob never has holes: Erase
+// moves the following bytes down over the erased string.
+template <typename Offset = uint32_t>
+class BasicStringVector
+{
+    static_assert(std::is_unsigned_v<Offset>, "Offset must be an unsigned integer type");
+
+public:
+    BasicStringVector() = default;
+
+    BasicStringVector(const BasicStringVector&) = delete;
+    BasicStringVector& operator=(const BasicStringVector&) = delete;
+
+    BasicStringVector(BasicStringVector&& other) noexcept;
+    BasicStringVector& operator=(BasicStringVector&& rhs) noexcept;
+
+    void Reserve(size_t count, size_t bytes);
+
+    void PushBack(std::string_view value);
+
+    template <typename It>
+    void Append(It first, It last);
+
+    void PopBack() noexcept;
+
+    void Erase(size_t index) noexcept;
+
+    void Swap(BasicStringVector& rhs) noexcept;
+
+    size_t Size() const noexcept;
+    size_t ByteSize() const noexcept;
+
+    Footprint MemoryFootprint() const noexcept;
+
+    std::string_view operator[](size_t index) const noexcept;
+
+private:
+    void ReserveBytes(size_t bytes);
+    // Makes room for `bytes` more, at least doubling the blob like PushBack on a Vector.
+    void GrowBytes(size_t bytes);
+    static Offset ToOffset(size_t value);
+
+    RawMemory<char> blob_;
+    size_t blob_size_ = 0;
+    Vector<Offset> offsets_;
+};
+
+using StringVector = BasicStringVector<uint32_t>;
+using LargeStringVector = BasicStringVector<uint64_t>;
+
+//------Costructer-----
+
+template<typename Offset>
+inline BasicStringVector<Offset>::BasicStringVector(BasicStringVector&& other) noexcept
+{
+    Swap(other);
+}
+
+template<typename Offset>
+inline BasicStringVector<Offset>& BasicStringVector<Offset>::operator=(BasicStringVector&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        Swap(rhs);
+    }
+    return *this;
+}
+
+//------------Methods--------------
+
+template<typename Offset>
+inline void BasicStringVector<Offset>::Reserve(size_t count, size_t bytes)
+{
+    offsets_.Reserve(count + 1);
+    ReserveBytes(bytes);
+}
+
+template<typename Offset>
+inline void BasicStringVector<Offset>::PushBack(std::string_view value)
+{
+    GrowBytes(value.size());
+    if (offsets_.Size() == 0)
+    {
+        offsets_.PushBack(0);
+    }
+    offsets_.PushBack(ToOffset(blob_size_ + value.size()));
+    if (!value.empty())
+    {
+        std::memcpy(blob_ + blob_size_, value.data(), value.size());
+    }
+    blob_size_ += value.size();
+}
+
+template<typename Offset>
+template<typename It>
+inline void BasicStringVector<Offset>::Append(It first, It last)
+{
+    using Category = typename std::iterator_traits<It>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>)
+    {
+        size_t count = 0;
+        size_t bytes = 0;
+        for (It it = first; it != last; ++it)
+        {
+            ++count;
+            bytes += std::string_view(*it).size();
+        }
+        // Doubled rather than exact, so that repeated small appends stay linear.
+        if (offsets_.Capacity() < Size() + count + 1)
+        {
+            Reserve(std::max(Size() + count, offsets_.Capacity() * 2), 0);
+        }
+        GrowBytes(bytes);
+    }
+    for (; first != last; ++first)
+    {
+        PushBack(std::string_view(*first));
+    }
+}
+
+template<typename Offset>
+inline void BasicStringVector<Offset>::PopBack() noexcept
+{
+    Erase(Size() - 1);
+}
+
+template<typename Offset>
+inline void BasicStringVector<Offset>::Erase(size_t index) noexcept
+{
+    assert(index < Size());
+    const size_t begin = offsets_[index];
+    const size_t end = offsets_[index + 1];
+    if (end != blob_size_)
+    {
+        std::memmove(blob_ + begin, blob_ + end, blob_size_ - end);
+    }
+    blob_size_ -= end - begin;
+    offsets_.Erase(offsets_.begin() + index + 1);
+    for (size_t i = index + 1; i < offsets_.Size(); ++i)
+    {
+        offsets_[i] -= static_cast<Offset>(end - begin);
+    }
+}
+
+template<typename Offset>
+inline void BasicStringVector<Offset>::Swap(BasicStringVector& rhs) noexcept
+{
+    blob_.Swap(rhs.blob_);
+    std::swap(blob_size_, rhs.blob_size_);
+    offsets_.Swap(rhs.offsets_);
+}
+
+template<typename Offset>
+inline size_t BasicStringVector<Offset>::Size() const noexcept
+{
+    return offsets_.Size() - (offsets_.Size() != 0);
+}
+
+template<typename Offset>
+inline size_t BasicStringVector<Offset>::ByteSize() const noexcept
+{
+    return blob_size_;
+}
+
+template<typename Offset>
+inline Footprint BasicStringVector<Offset>::MemoryFootprint() const noexcept
+{
+    Footprint result = offsets_.MemoryFootprint();
+    result.used_bytes += ByteSize();
+    result.reserved_bytes += blob_.Capacity();
+    result.slack_bytes += blob_.Capacity() - ByteSize();
+    return result;
+}
+
+template<typename Offset>
+inline void BasicStringVector<Offset>::ReserveBytes(size_t bytes)
+{
+    if (bytes <= blob_.Capacity())
+    {
+        return;
+    }
+    ToOffset(bytes);
+    RawMemory<char> new_blob(bytes);
+    if (blob_size_ != 0)
+    {
+        std::memcpy(new_blob.GetAddress(), blob_.GetAddress(), blob_size_);
+    }
+    blob_.Swap(new_blob);
+}
+
+template<typename Offset>
+inline void BasicStringVector<Offset>::GrowBytes(size_t bytes)
+{
+    if (blob_size_ + bytes > blob_.Capacity())
+    {
+        const size_t doubled = std::min<size_t>(blob_.Capacity() * 2, std::numeric_limits<Offset>::max());
+        ReserveBytes(std::max(doubled, blob_size_ + bytes));
+    }
+}
+
+template<typename Offset>
+inline Offset BasicStringVector<Offset>::ToOffset(size_t value)
+{
+    if (value > std::numeric_limits<Offset>::max())
+    {
+        throw std::length_error("StringVector blob exceeds the offset range");
+    }
+    return static_cast<Offset>(value);
+}
+
+//------------Operators-------------
+
+template<typename Offset>
+inline std::string_view BasicStringVector<Offset>::operator[](size_t index) const noexcept
+{
+    return std::string_view(blob_.GetAddress() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+}
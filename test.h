@@ -1,11 +1,47 @@
 #include "vector.h"
+#include "optional.h"
+#include "container_registry.h"
+#include "incremental_vector.h"
+#include "concurrent_queue.h"
+#include "string_vector.h"
+#include "views.h"
+#include "vector_expr.h"
+#include "sort.h"
+#include "indexed_vector.h"
+#include "static_vector.h"
+#include "matrix.h"
+#include "bulk_loader.h"
+#include "perf_counters.h"
+#include "sharded_collector.h"
+#include "dary_heap.h"
+#include "search_index.h"
+#include "shared_vector.h"
+#include "tracked_vector.h"
+#include "partition.h"
+#include "dict_vector.h"
+#include "parallel_construct.h"
+#include "trace_replay.h"
 
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 #include <algorithm>
 
+#ifdef VECTOR_HAS_SHARED_MEMORY
+#include <sys/wait.h>
+#endif
+
 namespace {
 
     // "" ,     
@@ -564,6 +600,1405 @@ void Test6() {
     }
 }
 
+void Test7() {
+    const size_t SIZE = 10;
+    {
+        Vector<int> v;
+        v.Reserve(SIZE);
+        v.PushBack(1);
+        const Footprint fp = v.MemoryFootprint();
+        assert(fp.used_bytes == sizeof(int));
+        assert(fp.reserved_bytes == SIZE * sizeof(int));
+        assert(fp.slack_bytes == (SIZE - 1) * sizeof(int));
+    }
+    {
+        Vector<Vector<int>> v(2);
+        v[0].Reserve(SIZE);
+        v[1].Resize(SIZE);
+        const Footprint fp = v.MemoryFootprint();
+        assert(fp.used_bytes == 2 * sizeof(Vector<int>) + SIZE * sizeof(int));
+        assert(fp.reserved_bytes == 2 * sizeof(Vector<int>) + 2 * SIZE * sizeof(int));
+        assert(fp.slack_bytes == SIZE * sizeof(int));
+    }
+    {
+        Vector<Optional<Vector<int>>> v(2);
+        v[1].Emplace(SIZE);
+        const Footprint fp = v.MemoryFootprint();
+        assert(fp.reserved_bytes == 2 * sizeof(Optional<Vector<int>>) + SIZE * sizeof(int));
+    }
+    {
+        auto& registry = ContainerRegistry::Instance();
+        Vector<int> small(SIZE);
+        Vector<int> large;
+        large.Reserve(SIZE * 10);
+        {
+            auto small_reg = registry.Register("small"s, small);
+            auto large_reg = registry.Register("large"s, large);
+            assert(registry.Count() == 2);
+            const auto snapshot = registry.TakeSnapshot(1);
+            assert(snapshot.containers == 2);
+            assert(snapshot.largest.Size() == 1);
+            assert(snapshot.largest[0].tag == "large"s);
+            assert(snapshot.total.slack_bytes == SIZE * 10 * sizeof(int));
+        }
+        assert(registry.Count() == 0);
+    }
+}
+
+void Test8() {
+    const size_t SIZE = 1000;
+    {
+        IncrementalVector<int> v;
+        bool was_migrating = false;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+            was_migrating = was_migrating || v.IsMigrating();
+            for (size_t j = 0; j <= i; j += 37) {
+                assert(v[j] == static_cast<int>(j));
+            }
+        }
+        assert(was_migrating);
+        assert(v.Size() == SIZE);
+        v.PopBack();
+        assert(v.Size() == SIZE - 1);
+        assert(v[SIZE - 2] == static_cast<int>(SIZE - 2));
+        int expected = 0;
+        for (int x : v) {
+            assert(x == expected++);
+        }
+        assert(!v.IsMigrating());
+    }
+    {
+        Obj::ResetCounters();
+        {
+            IncrementalVector<Obj> v;
+            // Stop in the middle of the 512 -> 1024 migration
+            const size_t count = 600;
+            for (size_t i = 0; i < count; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            assert(v.IsMigrating());
+            assert(Obj::num_copied == 0);
+            assert(Obj::GetAliveObjectCount() == count);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        IncrementalVector<TestObj> v;
+        v.PushBack(TestObj{});
+        v.PushBack(TestObj{});
+        // The grow step must not invalidate an argument that refers to an element
+        v.PushBack(v[0]);
+        assert(v[0].IsAlive() && v[1].IsAlive() && v[2].IsAlive());
+    }
+}
+
+void Test9() {
+    {
+        SpscQueue<std::unique_ptr<int>> q(3);
+        assert(q.Capacity() == 4);
+        for (int i = 0; i < 4; ++i) {
+            assert(q.TryPush(std::make_unique<int>(i)));
+        }
+        assert(!q.TryPush(std::make_unique<int>(4)));
+        std::unique_ptr<int> out;
+        assert(q.TryPop(out) && *out == 0);
+        Vector<std::unique_ptr<int>> batch;
+        assert(q.TryPopBatch(batch, 10) == 3);
+        assert(*batch[0] == 1 && *batch[2] == 3);
+        assert(!q.TryPop(out));
+        assert(q.TryPushBatch(batch.begin(), batch.end()) == 3);
+        assert(q.TryPop(out) && *out == 1);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            MpmcQueue<Obj> q(8);
+            for (int i = 0; i < 8; ++i) {
+                assert(q.TryEmplace(i));
+            }
+            assert(!q.TryEmplace(8));
+            Obj out;
+            assert(q.TryPop(out) && out.id == 0);
+            Vector<Obj> batch;
+            assert(q.TryPopBatch(batch, 3) == 3);
+            assert(batch[2].id == 3);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        const int COUNT = 100'000;
+        MpmcQueue<int> q(64);
+        std::atomic<long long> sum{ 0 };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&q]() {
+                for (int i = 1; i <= COUNT; ++i) {
+                    while (!q.TryPush(i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            threads.emplace_back([&q, &sum]() {
+                int value = 0;
+                for (int i = 0; i < COUNT; ++i) {
+                    while (!q.TryPop(value)) {
+                        std::this_thread::yield();
+                    }
+                    sum += value;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(sum == 2LL * COUNT * (COUNT + 1) / 2);
+    }
+    {
+        struct Ticket {
+            explicit Ticket(int id) : id(id) {}
+            int id;
+        };
+        static_assert(!std::is_default_constructible_v<Ticket>);
+        MpmcQueue<Ticket> q(4);
+        std::vector<Ticket> tickets;
+        for (int i = 0; i < 6; ++i) {
+            tickets.emplace_back(i);
+        }
+        assert(q.TryPushBatch(tickets.begin(), tickets.end()) == 4);
+        Vector<Ticket> popped;
+        assert(q.TryPopBatch(popped, 3) == 3 && popped[2].id == 2);
+        assert(q.TryPushBatch(tickets.begin() + 4, tickets.end()) == 2);
+        assert(q.TryPopBatch(popped, 10) == 3 && popped[3].id == 3 && popped[5].id == 5);
+        assert(q.TryPopBatch(popped, 10) == 0);
+    }
+    {
+        const int COUNT = 100'000;
+        const int BATCH = 7;
+        MpmcQueue<int> q(64);
+        std::atomic<long long> sum{ 0 };
+        std::atomic<int> popped{ 0 };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&q]() {
+                std::vector<int> batch;
+                for (int i = 1; i <= COUNT; i += BATCH) {
+                    batch.clear();
+                    for (int j = i; j < i + BATCH && j <= COUNT; ++j) {
+                        batch.push_back(j);
+                    }
+                    for (auto it = batch.begin(); it != batch.end();) {
+                        const size_t pushed = q.TryPushBatch(it, batch.end());
+                        it += pushed;
+                        if (pushed == 0) {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            });
+            threads.emplace_back([&q, &sum, &popped]() {
+                Vector<int> batch;
+                while (popped.load() < 2 * COUNT) {
+                    batch.Clear();
+                    const size_t count = q.TryPopBatch(batch, 5);
+                    if (count == 0) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    sum += std::accumulate(batch.begin(), batch.end(), 0LL);
+                    popped += static_cast<int>(count);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(popped == 2 * COUNT && sum == 2LL * COUNT * (COUNT + 1) / 2);
+    }
+    {
+        // A consumer appending one item at a time must not reallocate every call
+        SpscQueue<int> spsc(4);
+        MpmcQueue<int> mpmc(4);
+        Vector<int> spsc_out;
+        Vector<int> mpmc_out;
+        int spsc_reallocations = 0;
+        int mpmc_reallocations = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const size_t spsc_capacity = spsc_out.Capacity();
+            const size_t mpmc_capacity = mpmc_out.Capacity();
+            assert(spsc.TryPush(i) && spsc.TryPopBatch(spsc_out, 1) == 1);
+            assert(mpmc.TryPush(i) && mpmc.TryPopBatch(mpmc_out, 1) == 1);
+            spsc_reallocations += spsc_out.Capacity() != spsc_capacity;
+            mpmc_reallocations += mpmc_out.Capacity() != mpmc_capacity;
+        }
+        assert(spsc_out[999] == 999 && mpmc_out[999] == 999);
+        assert(spsc_reallocations <= 11 && mpmc_reallocations <= 11);
+    }
+}
+
+void Test10() {
+    using namespace std::literals;
+    {
+        StringVector v;
+        v.PushBack("alpha"sv);
+        v.PushBack(""sv);
+        v.PushBack("gamma"sv);
+        assert(v.Size() == 3);
+        assert(v[0] == "alpha"sv && v[1].empty() && v[2] == "gamma"sv);
+        assert(v.ByteSize() == 10);
+
+        std::vector<std::string> more = { "delta"s, "epsilon"s };
+        v.Append(more.begin(), more.end());
+        assert(v.Size() == 5);
+        assert(v[4] == "epsilon"sv);
+
+        v.Erase(0);
+        assert(v.Size() == 4);
+        assert(v[0].empty() && v[1] == "gamma"sv);
+        assert(v.ByteSize() == 17);
+        assert(v[1] == "gamma"sv && v[3] == "epsilon"sv);
+
+        v.Erase(2);
+        assert(v.Size() == 3);
+        assert(v.ByteSize() == 12);
+        assert(v[1] == "gamma"sv && v[2] == "epsilon"sv);
+
+        v.PopBack();
+        v.PopBack();
+        v.PopBack();
+        assert(v.Size() == 0 && v.ByteSize() == 0);
+        v.PushBack("zeta"sv);
+        assert(v.Size() == 1 && v[0] == "zeta"sv);
+    }
+    {
+        BasicStringVector<uint8_t> v;
+        v.PushBack(std::string(200, 'a'));
+        try {
+            v.PushBack(std::string(100, 'b'));
+            assert(false && "Exception is expected");
+        }
+        catch (const std::length_error&) {
+        }
+        assert(v.Size() == 1);
+    }
+    {
+        // Appending a few strings at a time must not reallocate on every call
+        StringVector v;
+        const std::vector<std::string> batch = { "key"s };
+        int reallocations = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const size_t reserved = v.MemoryFootprint().reserved_bytes;
+            v.Append(batch.begin(), batch.end());
+            reallocations += v.MemoryFootprint().reserved_bytes != reserved;
+        }
+        assert(v.Size() == 1000 && v[999] == "key"sv);
+        assert(reallocations <= 22);
+    }
+}
+
+void Test11() {
+    const int SIZE = 20;
+    Vector<int> v;
+    for (int i = 0; i < SIZE; ++i) {
+        v.PushBack(i);
+    }
+    {
+        auto result = AsView(v)
+            .Filter([](int x) { return x % 2 == 0; })
+            .Map([](int x) { return x * 10; })
+            .Take(3)
+            .Collect();
+        assert(result.Size() == 3);
+        assert(result[0] == 0 && result[1] == 20 && result[2] == 40);
+    }
+    {
+        int calls = 0;
+        auto mapped = AsView(v).Map([&calls](int x) { ++calls; return x + 1; }).Stride(5);
+        assert(calls == 0);
+        auto result = mapped.Collect();
+        assert(result.Capacity() == 4);
+        assert(result.Size() == 4 && result[3] == 16);
+        assert(calls == 4);
+    }
+    {
+        Vector<std::string> names;
+        names.PushBack("a"s);
+        names.PushBack("b"s);
+        auto zipped = AsView(v).Zip(AsView(names)).Collect();
+        assert(zipped.Size() == 2);
+        assert(zipped[1].first == 1 && zipped[1].second == "b"s);
+    }
+    {
+        auto sums = AsView(v).Chunk(6).Map([](VectorRange<int> chunk) {
+            int sum = 0;
+            chunk.ForEach([&sum](int x) { sum += x; });
+            return sum;
+            }).Collect();
+        assert(sums.Size() == 4);
+        assert(sums[0] == 15 && sums[3] == 18 + 19);
+    }
+}
+
+void Test12() {
+    const size_t SIZE = 100;
+    Vector<double> a(SIZE);
+    Vector<double> b(SIZE);
+    Vector<int> c(SIZE);
+    for (size_t i = 0; i < SIZE; ++i) {
+        a[i] = static_cast<double>(i);
+        b[i] = 2.0;
+        c[i] = static_cast<int>(i % 3);
+    }
+    {
+        Vector<double> result = Evaluate(a + b * c - 1.0);
+        assert(result.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(result[i] == a[i] + b[i] * c[i] - 1.0);
+        }
+    }
+    {
+        Vector<double> result;
+        Assign(result, 2.0 * a / b);
+        assert(result.Size() == SIZE && result[7] == 7.0);
+        Assign(result, result + a);
+        assert(result[7] == 14.0);
+    }
+    {
+        assert(Sum(a * 1.0) == SIZE * (SIZE - 1) / 2.0);
+        assert(Min(a - 10.0) == -10.0);
+        assert(Max(c) == 2);
+    }
+    {
+        Vector<double> shorter(SIZE - 1);
+        try {
+            [[maybe_unused]] auto expr = a + shorter;
+            assert(false && "Exception is expected");
+        }
+        catch (const std::invalid_argument&) {
+        }
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 50'000;
+    uint64_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return seed >> 11;
+    };
+    {
+        Vector<uint64_t> v;
+        std::vector<uint64_t> expected;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(next());
+            expected.push_back(v[i]);
+        }
+        std::sort(expected.begin(), expected.end());
+        RadixSort<11>(v);
+        assert(std::equal(v.begin(), v.end(), expected.begin()));
+    }
+    {
+        Vector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(next() % 2001) - 1000);
+        }
+        RadixSort<16>(v);
+        assert(std::is_sorted(v.begin(), v.end()));
+    }
+    {
+        Vector<double> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack((static_cast<double>(next() % 100'000) - 50'000.0) / 7.0);
+        }
+        RadixSort(v);
+        assert(std::is_sorted(v.begin(), v.end()));
+    }
+    {
+        Vector<std::pair<uint16_t, std::string>> records;
+        for (size_t i = 0; i < 1000; ++i) {
+            records.PushBack({ static_cast<uint16_t>(next() % 10), std::to_string(i) });
+        }
+        RadixSortBy(records, [](const auto& record) { return record.first; });
+        assert(std::is_sorted(records.begin(), records.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first < rhs.first;
+            }));
+        for (size_t i = 1; i < records.Size(); ++i) {
+            if (records[i - 1].first == records[i].first) {
+                assert(std::stoi(records[i - 1].second) < std::stoi(records[i].second));
+            }
+        }
+    }
+    {
+        Vector<uint64_t> v;
+        for (size_t i = 0; i < SIZE * 4; ++i) {
+            v.PushBack(next() % 1000);
+        }
+        ParallelSort(v, std::greater<>{}, 5);
+        assert(std::is_sorted(v.begin(), v.end(), std::greater<>{}));
+    }
+}
+
+void Test14() {
+    struct Entity {
+        int id;
+        std::string name;
+    };
+    struct EntityId {
+        int operator()(const Entity& entity) const {
+            return entity.id;
+        }
+    };
+    {
+        IndexedVector<Entity, EntityId> v;
+        const int COUNT = 1000;
+        for (int i = 0; i < COUNT; ++i) {
+            assert(v.PushBack(Entity{ i * 7, std::to_string(i) }));
+        }
+        assert(!v.PushBack(Entity{ 0, "duplicate"s }));
+        assert(v.Size() == COUNT);
+        for (int i = 0; i < COUNT; ++i) {
+            const Entity* found = v.Find(i * 7);
+            assert(found != nullptr && found->name == std::to_string(i));
+        }
+        assert(v.Find(1) == nullptr);
+
+        assert(v.EraseKey(0));
+        assert(!v.EraseKey(0));
+        assert(v.Size() == COUNT - 1);
+        assert(v[0].id == (COUNT - 1) * 7);
+        for (int i = 1; i < COUNT; i += 2) {
+            assert(v.EraseKey(i * 7));
+        }
+        for (int i = 1; i < COUNT; ++i) {
+            assert(v.Contains(i * 7) == (i % 2 == 0));
+        }
+        // Tombstones must not stop inserts from finding their slot
+        for (int i = 0; i < COUNT; ++i) {
+            v.PushBack(Entity{ i * 7, std::to_string(i) });
+        }
+        assert(v.Size() == COUNT);
+    }
+    {
+        Vector<Entity> bulk;
+        bulk.PushBack(Entity{ 1, "a"s });
+        bulk.PushBack(Entity{ 2, "b"s });
+        bulk.PushBack(Entity{ 1, "c"s });
+        IndexedVector<Entity, EntityId> v;
+        v.Assign(std::move(bulk));
+        assert(v.Size() == 2);
+        assert(v.Find(1)->name == "a"s);
+        assert(v.Find(2)->name == "b"s);
+    }
+}
+
+void Test15() {
+    {
+        // Growth holds the old and the new buffer at the same time
+        MemoryBudget budget(20 * sizeof(int));
+        Vector<int> v;
+        v.SetBudget(&budget);
+        for (int i = 0; i < 8; ++i) {
+            assert(v.TryPushBack(i) == AllocStatus::kOk);
+        }
+        assert(budget.Used() == 8 * sizeof(int));
+        // Growing to 16 elements needs 8 + 16 ints at once
+        assert(v.TryPushBack(8) == AllocStatus::kBudgetExceeded);
+        assert(v.Size() == 8 && v.Capacity() == 8);
+        assert(v.TryReserve(10) == AllocStatus::kOk);
+        assert(budget.Used() == 10 * sizeof(int));
+        assert(v.TryEmplaceBack(8) == AllocStatus::kOk);
+        try {
+            v.Reserve(100);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::bad_alloc&) {
+        }
+        assert(v.Size() == 9 && v[8] == 8);
+        {
+            Vector<int> copy(v);
+            assert(copy.Budget() == &budget);
+        }
+        assert(budget.Used() == 10 * sizeof(int));
+        v.SetBudget(nullptr);
+        assert(budget.Used() == 0);
+    }
+    {
+        static size_t pressure_calls = 0;
+        static MemoryBudget* shared = nullptr;
+        MemoryBudget budget(4 * sizeof(int));
+        shared = &budget;
+        SetMemoryPressureHook([](size_t, AllocStatus status) {
+            ++pressure_calls;
+            if (status == AllocStatus::kBudgetExceeded) {
+                shared->SetLimit(1024);
+                return true;
+            }
+            return false;
+            });
+        Vector<int> v;
+        v.SetBudget(&budget);
+        for (int i = 0; i < 8; ++i) {
+            assert(v.TryPushBack(i) == AllocStatus::kOk);
+        }
+        assert(pressure_calls == 1);
+        assert(v.TryReserve(static_cast<size_t>(-1) / 2) != AllocStatus::kOk);
+        SetMemoryPressureHook(nullptr);
+    }
+    {
+        Obj::ResetCounters();
+        MemoryBudget budget(0);
+        {
+            Vector<Obj> v;
+            v.SetBudget(&budget);
+            assert(v.TryEmplaceBack(1) == AllocStatus::kBudgetExceeded);
+            assert(Obj::GetAliveObjectCount() == 0);
+        }
+        assert(budget.Used() == 0);
+    }
+}
+
+constexpr int StaticVectorSum() {
+    StaticVector<int, 8> v;
+    for (int i = 1; i <= 4; ++i) {
+        v.PushBack(i);
+    }
+    v.Insert(v.begin(), 10);
+    v.Erase(v.begin() + 1);
+    int sum = 0;
+    for (int x : v) {
+        sum += x;
+    }
+    return sum;
+}
+
+struct RouteHop {
+    uint32_t node = 0;
+    uint16_t port = 80;
+};
+
+constexpr StaticVector<RouteHop, 4> MakeRoute() {
+    StaticVector<RouteHop, 4> route;
+    route.PushBack(RouteHop{ 7, 443 });
+    route.EmplaceBack();
+    return route;
+}
+
+void Test16() {
+    static_assert(StaticVectorSum() == 10 + 2 + 3 + 4);
+    static_assert(!std::is_trivial_v<RouteHop> && std::is_trivially_copyable_v<StaticVector<RouteHop, 4>>);
+    static_assert(MakeRoute().Size() == 2 && MakeRoute()[0].port == 443 && MakeRoute()[1].port == 80);
+    static_assert(std::is_trivially_copyable_v<StaticVector<int, 16>>);
+    static_assert(!std::is_trivially_copyable_v<StaticVector<std::string, 16>>);
+    static_assert(sizeof(StaticVector<int, 16>::size_type) == 1);
+    static_assert(sizeof(StaticVector<char, 1000>::size_type) == 2);
+    {
+        StaticVector<int, 4> v;
+        v.PushBack(1);
+        v.PushBack(2);
+        v.EmplaceBack(3);
+        v.PushBack(v[0]);
+        assert(v.Full());
+        try {
+            v.PushBack(5);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::length_error&) {
+        }
+        assert(v.Size() == 4 && v[3] == 1);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            StaticVector<Obj, 8> v(3);
+            v.Emplace(v.cbegin() + 1, 42, "Ivan"s);
+            assert(v.Size() == 4);
+            assert(v[1].id == 42 && v[1].name == "Ivan"s);
+            auto copy = v;
+            assert(copy.Size() == 4 && copy[1].id == 42);
+            v.Erase(v.cbegin());
+            assert(v[0].id == 42);
+            assert(Obj::GetAliveObjectCount() == 7);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        StaticVector<std::string, 4> v;
+        v.PushBack("a"s);
+        v.PushBack("b"s);
+        v.Insert(v.cbegin(), v[1]);
+        assert(v[0] == "b"s && v[1] == "a"s && v[2] == "b"s);
+    }
+}
+
+void Test17() {
+    {
+        Matrix<double> m(3, 5);
+        assert(m.Stride() == 8);
+        assert(reinterpret_cast<uintptr_t>(m.RowData(1)) % kMatrixAlignment == 0);
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 5; ++j) {
+                m(i, j) = static_cast<double>(i * 10 + j);
+            }
+        }
+        auto column = m.Column(2);
+        assert(column.Rows() == 3 && column(2, 0) == 22.0);
+        auto sub = m.Submatrix(1, 1, 2, 3);
+        sub(0, 0) = -1.0;
+        assert(m(1, 1) == -1.0 && sub(1, 2) == 23.0);
+
+        Matrix<double> t = m.Transposed();
+        assert(t.Rows() == 5 && t.Cols() == 3);
+        assert(t(4, 2) == m(2, 4) && t(1, 1) == -1.0);
+    }
+    {
+        const size_t N = 70;
+        Matrix<double> a(N, N + 3);
+        Matrix<double> b(N + 3, N - 1);
+        for (size_t i = 0; i < a.Rows(); ++i) {
+            for (size_t j = 0; j < a.Cols(); ++j) {
+                a(i, j) = static_cast<double>((i + 2 * j) % 7);
+            }
+        }
+        for (size_t i = 0; i < b.Rows(); ++i) {
+            for (size_t j = 0; j < b.Cols(); ++j) {
+                b(i, j) = static_cast<double>((3 * i + j) % 5);
+            }
+        }
+        Matrix<double> c = a * b;
+        for (size_t i = 0; i < c.Rows(); i += 7) {
+            for (size_t j = 0; j < c.Cols(); j += 5) {
+                double expected = 0.0;
+                for (size_t k = 0; k < a.Cols(); ++k) {
+                    expected += a(i, k) * b(k, j);
+                }
+                assert(c(i, j) == expected);
+            }
+        }
+        Matrix<double> sum = c + c;
+        sum -= c;
+        sum *= 2.0;
+        assert(sum(3, 4) == 2.0 * c(3, 4));
+        try {
+            [[maybe_unused]] auto bad = a * a;
+            assert(false && "Exception is expected");
+        }
+        catch (const std::invalid_argument&) {
+        }
+    }
+}
+
+void Test18() {
+    const std::string path = std::filesystem::temp_directory_path() / "vector_bulk_loader_test.bin";
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        for (uint64_t i = 0; i < 1000; ++i) {
+            std::fwrite(&i, sizeof(i), 1, file);
+        }
+        std::fclose(file);
+
+        Vector<uint64_t> values;
+        values.PushBack(42);
+        const LoadStats stats = LoadBinaryRecords(path, values, 0, 100);
+        assert(stats.records == 1000 && stats.bytes == 8000);
+        assert(values.Size() == 1001 && values[0] == 42 && values[1000] == 999);
+
+        Vector<uint64_t> tail;
+        LoadBinaryRecords(path, tail, 990 * sizeof(uint64_t));
+        assert(tail.Size() == 10 && tail[0] == 990);
+
+        Vector<std::array<char, 3>> odd;
+        try {
+            LoadBinaryRecords(path, odd);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        for (int i = 0; i < 500; ++i) {
+            std::fprintf(file, "%d,%d\r\n", i, i * i);
+        }
+        std::fprintf(file, "500,250000");
+        std::fclose(file);
+
+        Vector<std::pair<int, int>> rows;
+        const auto parse = [](std::string_view line) {
+            const size_t comma = line.find(',');
+            return std::make_pair(std::stoi(std::string(line.substr(0, comma))),
+                std::stoi(std::string(line.substr(comma + 1))));
+        };
+        const LoadStats stats = LoadTextRecords(path, rows, parse, 7);
+        assert(stats.records == 501 && rows.Size() == 501);
+        assert(rows[123].first == 123 && rows[123].second == 123 * 123);
+        assert(rows[500].second == 250000);
+
+        try {
+            LoadTextRecords(path, rows, [](std::string_view) -> std::pair<int, int> {
+                throw std::invalid_argument("bad row");
+            });
+            assert(false && "Exception is expected");
+        }
+        catch (const std::invalid_argument&) {
+        }
+    }
+    std::remove(path.c_str());
+    try {
+        Vector<int> missing;
+        LoadBinaryRecords(path, missing);
+        assert(false && "Exception is expected");
+    }
+    catch (const std::runtime_error&) {
+    }
+}
+
+void Test19() {
+    {
+        PerfCounters counters;
+        counters.Start();
+        Vector<int> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        const PerfSample sample = counters.Stop();
+        assert(counters.Available() == sample.Any());
+    }
+    {
+        PerfSample sample;
+        sample.values[static_cast<size_t>(PerfEvent::kCycles)] = 300;
+        sample.available[static_cast<size_t>(PerfEvent::kCycles)] = true;
+        std::ostringstream out;
+        PrintPerfSample(out, "case", sample, 100);
+        assert(out.str() == "case: cycles/op 3, instructions/op n/a, L1d misses/op n/a, LLC misses/op n/a, "
+            "branch misses/op n/a, dTLB misses/op n/a\n");
+
+        std::ostringstream none;
+        PrintPerfSample(none, "case", PerfSample{}, 100);
+        assert(none.str() == "case: hardware counters unavailable\n");
+    }
+}
+
+void Test20() {
+    const size_t THREADS = 4;
+    const int PER_THREAD = 20000;
+    {
+        ShardedCollector<int> collector(THREADS);
+        std::vector<std::thread> producers;
+        for (size_t t = 0; t < THREADS; ++t) {
+            producers.emplace_back([&collector, t]() {
+                Vector<int>& shard = collector.Shard(t);
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    shard.PushBack(static_cast<int>(t) * PER_THREAD + i);
+                }
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+        assert(collector.Size() == THREADS * PER_THREAD);
+
+        Vector<int> out;
+        out.PushBack(-1);
+        collector.MergeInto(out, MergeOrder::kOrdered, THREADS);
+        assert(out.Size() == THREADS * PER_THREAD + 1 && collector.Size() == 0);
+        for (size_t i = 1; i < out.Size(); ++i) {
+            assert(out[i] == static_cast<int>(i) - 1);
+        }
+    }
+    {
+        ShardedCollector<std::string> collector(3);
+        collector.Shard(0).Reserve(10);
+        collector.Shard(0).PushBack("a");
+        collector.Shard(1).PushBack("b");
+        collector.Shard(1).PushBack("c");
+        collector.Shard(2).PushBack("d");
+        const std::string* adopted = collector.Shard(0).begin();
+
+        Vector<std::string> out;
+        collector.MergeInto(out, MergeOrder::kUnordered);
+        assert(out.Size() == 4 && out.begin() == adopted);
+        std::sort(out.begin(), out.end());
+        assert(out[0] == "a" && out[3] == "d");
+    }
+    {
+        struct Fragile {
+            explicit Fragile(int value) : value(value) {}
+            Fragile(const Fragile& other) : value(other.value) {
+                if (value == 13) {
+                    throw std::runtime_error("copy");
+                }
+            }
+            Fragile(Fragile&& other) : value(other.value) {}
+            int value;
+        };
+        ShardedCollector<Fragile> collector(2);
+        collector.Shard(0).EmplaceBack(1);
+        collector.Shard(1).EmplaceBack(13);
+        Vector<Fragile> out;
+        out.EmplaceBack(7);
+        try {
+            collector.MergeInto(out);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(out.Size() == 1 && out[0].value == 7 && collector.Size() == 2);
+    }
+}
+
+void Test21() {
+    {
+        DaryHeap<int> heap;
+        Vector<int> values;
+        for (int i = 0; i < 1000; ++i) {
+            values.PushBack((i * 7919) % 1000);
+        }
+        heap.Heapify(values);
+        heap.PushBatch(values.begin(), values.begin() + 10);
+        heap.Push(5000);
+        assert(heap.Size() == 1011 && heap.Top() == 5000);
+        int previous = heap.Pop();
+        while (!heap.Empty()) {
+            const int current = heap.Pop();
+            assert(current <= previous);
+            previous = current;
+        }
+    }
+    {
+        using Entry = std::pair<int, int>;
+        DaryHeap<Entry, 8, std::greater<Entry>, true> heap;
+        Vector<DaryHeap<Entry, 8, std::greater<Entry>, true>::Handle> handles;
+        for (int i = 0; i < 100; ++i) {
+            handles.PushBack(heap.Push({ 1000 + i, i }));
+        }
+        Vector<Entry> batch;
+        for (int i = 100; i < 200; ++i) {
+            batch.PushBack({ 1000 + i, i });
+        }
+        heap.PushBatch(batch.begin(), batch.end(), &handles);
+        assert(handles.Size() == 200 && heap.Get(handles[150]).second == 150);
+
+        heap.DecreaseKey(handles[150], { 1, 150 });
+        heap.DecreaseKey(handles[42], { 2, 42 });
+        assert(heap.Top().second == 150);
+        assert(heap.Pop().second == 150 && heap.Pop().second == 42);
+        assert(heap.Pop().second == 0);
+
+        const auto reused = heap.Push({ 0, 999 });
+        assert(reused == handles[0] || reused == handles[42] || reused == handles[150]);
+        heap.DecreaseKey(handles[199], { -1, 199 });
+        assert(heap.Pop().second == 199 && heap.Pop().second == 999);
+
+        int previous = -1;
+        size_t popped = 0;
+        while (!heap.Empty()) {
+            const Entry top = heap.Pop();
+            assert(top.first > previous);
+            previous = top.first;
+            ++popped;
+        }
+        assert(popped == 196);
+    }
+}
+
+void Test22() {
+    for (size_t n : { 0, 1, 2, 7, 8, 9, 100, 1000 }) {
+        Vector<uint64_t> sorted;
+        for (size_t i = 0; i < n; ++i) {
+            sorted.PushBack((i / 3) * 10);
+        }
+        const SearchIndex<uint64_t> index(sorted);
+        assert(index.Size() == n);
+
+        Vector<uint64_t> keys;
+        for (uint64_t key = 0; key <= n * 4 + 10; key += 3) {
+            keys.PushBack(key);
+        }
+        Vector<size_t> positions;
+        index.LowerBoundMany(keys, positions);
+        assert(positions.Size() == keys.Size());
+        for (size_t i = 0; i < keys.Size(); ++i) {
+            const size_t expected = std::lower_bound(sorted.begin(), sorted.end(), keys[i]) - sorted.begin();
+            assert(index.LowerBound(keys[i]) == expected);
+            assert(positions[i] == expected);
+        }
+    }
+    {
+        Vector<int> descending;
+        for (int i = 50; i > 0; --i) {
+            descending.PushBack(i);
+        }
+        const SearchIndex<int, std::greater<int>> index(descending, std::greater<int>{});
+        assert(index.LowerBound(60) == 0);
+        assert(index.LowerBound(25) == 25);
+        assert(index.LowerBound(0) == 50);
+    }
+}
+
+void Test23() {
+    {
+        Vector<std::string> v;
+        v.PushBack("alpha");
+        v.PushBack("beta");
+        const std::string* data = v.Data();
+        ReleasedBuffer<std::string> buffer = v.Release();
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.Data() == nullptr);
+        assert(buffer.data == data && buffer.size == 2 && buffer.capacity == 2);
+
+        Vector<std::string> other;
+        other.PushBack("gone");
+        other.Adopt(buffer.data, buffer.size, buffer.capacity, buffer.deleter);
+        assert(other.Data() == data && other[1] == "beta");
+        other.PushBack("gamma");
+        assert(other.Size() == 3 && other[0] == "alpha");
+        other.Release().Dispose();
+    }
+    {
+        const size_t CAPACITY = 16;
+        int* raw = static_cast<int*>(std::malloc(CAPACITY * sizeof(int)));
+        for (int i = 0; i < 10; ++i) {
+            raw[i] = i * i;
+        }
+        Vector<int> v;
+        v.Adopt(raw, 10, CAPACITY, BufferDeleter<int>::StdFree());
+        assert(v.Data() == raw && v.Capacity() == CAPACITY && v[9] == 81);
+        for (int i = 0; i < 20; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Data() != raw && v[9] == 81 && v.Size() == 30);
+    }
+    {
+        MemoryBudget budget(1024);
+        Vector<int> v;
+        v.SetBudget(&budget);
+        v.Reserve(64);
+        assert(budget.Used() == 64 * sizeof(int));
+        ReleasedBuffer<int> buffer = v.Release();
+        assert(budget.Used() == 0);
+        v.Adopt(buffer.data, buffer.size, buffer.capacity, buffer.deleter);
+        assert(budget.Used() == 64 * sizeof(int));
+    }
+}
+
+void Test24() {
+    {
+        Vector<std::string> v;
+        v.Reserve(10);
+        v.PushBack("a");
+        v.Resize(5);
+        assert(v.Size() == 5 && v[0] == "a" && v[4].empty());
+        v.ShrinkToFit();
+        assert(v.Capacity() == 5 && v[0] == "a");
+        v.ClearAndTrim();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+    }
+    {
+        Vector<int> v;
+        v.SetDecayPolicy({ 8, 25 });
+        for (int i = 0; i < 1024; ++i) {
+            v.PushBack(i);
+        }
+        const size_t peak = v.Capacity();
+        while (v.Size() > 100) {
+            v.PopBack();
+        }
+        assert(v.Capacity() < peak && v.Capacity() >= v.Size());
+        assert(v[99] == 99);
+
+        const size_t after_spike = v.Capacity();
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+            v.PopBack();
+        }
+        assert(v.Capacity() == after_spike);
+
+        v.Clear();
+        for (size_t i = 0; i < 8; ++i) {
+            v.Clear();
+        }
+        assert(v.Capacity() == 0);
+    }
+    {
+        MemoryBudget budget(1 << 20);
+        Vector<int> v;
+        v.SetBudget(&budget);
+        v.Resize(1000);
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(budget.Used() == 10 * sizeof(int));
+        v.ClearAndTrim();
+        assert(budget.Used() == 0);
+    }
+    {
+        Vector<int> v;
+        for (int i = 0; i < 64; ++i) {
+            v.PushBack(i);
+        }
+        while (v.Size() > 16) {
+            v.PopBack();
+        }
+        v.SetDecayPolicy({ 1, 25 });
+        const size_t before = v.Capacity();
+        const auto it = v.Erase(v.begin() + 2);
+        assert(v.Capacity() < before && it == v.begin() + 2 && *it == 3);
+    }
+}
+
+void Test25() {
+#ifdef VECTOR_HAS_SHARED_MEMORY
+    struct Row {
+        uint64_t key;
+        double value;
+    };
+    const std::string name = "/vector_test_" + std::to_string(::getpid());
+    SharedVector<Row>::Unlink(name);
+    {
+        SharedVector<Row> writer = SharedVector<Row>::Create(name, 4);
+        SharedVector<Row> reader = SharedVector<Row>::Open(name);
+        assert(writer.IsWriter() && !reader.IsWriter());
+        assert(reader.Size() == 0 && reader.Capacity() == 4);
+
+        for (uint64_t i = 0; i < 1000; ++i) {
+            writer.PushBack({ i, i * 0.5 });
+        }
+        assert(reader.Size() == 1000 && reader.Capacity() >= 1000);
+        assert(reader.Get(999).key == 999 && reader.Get(10).value == 5.0);
+
+        writer.Set(10, { 10, -1.0 });
+        const Vector<Row> snapshot = reader.Snapshot();
+        assert(snapshot.Size() == 1000 && snapshot[10].value == -1.0);
+
+        try {
+            reader.PushBack({ 0, 0.0 });
+            assert(false && "Exception is expected");
+        }
+        catch (const std::logic_error&) {
+        }
+        try {
+            SharedVector<int> wrong = SharedVector<int>::Open(name);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        const pid_t child = ::fork();
+        if (child == 0) {
+            SharedVector<Row> other = SharedVector<Row>::Open(name);
+            ::_exit(other.Size() == 1000 && other.Get(500).key == 500 ? 0 : 1);
+        }
+        int status = 0;
+        ::waitpid(child, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    SharedVector<Row>::Unlink(name);
+    try {
+        SharedVector<Row>::Open(name);
+        assert(false && "Exception is expected");
+    }
+    catch (const std::runtime_error&) {
+    }
+#ifdef __linux__
+    {
+        SharedVector<int> writer = SharedVector<int>::CreateAnonymous(1);
+        SharedVector<int> reader = SharedVector<int>::OpenFd(writer.Fd());
+        const int values[] = { 1, 2, 3 };
+        writer.Append(std::begin(values), std::end(values));
+        assert(reader.Size() == 3 && reader.Get(2) == 3);
+        writer.Clear();
+        assert(reader.Size() == 0);
+    }
+#endif
+#endif
+}
+
+void Test26() {
+    {
+        TrackedVector<int> source(4);
+        Vector<int> replica;
+        for (int i = 0; i < 100; ++i) {
+            source.PushBack(i);
+        }
+        DirtySet<int> changes = source.CollectDirty();
+        assert(changes.size == 100 && changes.patches.Size() == 1 && changes.DirtyElements() == 100);
+        ApplyPatches(replica, changes);
+        assert(replica.Size() == 100 && replica[99] == 99);
+
+        assert(source.CollectDirty().patches.Size() == 0);
+
+        source[5] = -5;
+        source.Set(6, -6);
+        source[50] = -50;
+        const int untouched = std::as_const(source)[90];
+        assert(untouched == 90);
+        changes = source.CollectDirty();
+        assert(changes.patches.Size() == 2);
+        assert(changes.patches[0].offset == 4 && changes.patches[0].count == 4);
+        assert(changes.patches[1].offset == 48 && changes.DirtyElements() == 8);
+        ApplyPatches(replica, changes);
+        assert(replica[5] == -5 && replica[6] == -6 && replica[50] == -50);
+
+        source.Erase(97);
+        source.Insert(0, 1000);
+        source.PopBack();
+        changes = source.CollectDirty();
+        assert(changes.size == 99 && changes.DirtyElements() == 99);
+        ApplyPatches(replica, changes);
+        assert(std::equal(replica.begin(), replica.end(), source.begin(), source.end()));
+    }
+    {
+        Vector<uint64_t> values(10000);
+        TrackedVector<uint64_t> source(std::move(values));
+        assert(source.BlockElements() == 512);
+        Vector<uint64_t> replica;
+        ApplyPatches(replica, source.CollectDirty());
+        source.Resize(10100);
+        source[3] = 3;
+        const DirtySet<uint64_t> changes = source.CollectDirty();
+        assert(changes.DirtyElements() == 512 + (10100 - 19 * 512));
+        ApplyPatches(replica, changes);
+        assert(replica.Size() == 10100 && replica[3] == 3);
+    }
+}
+
+void Test27() {
+    struct Sale {
+        uint32_t store;
+        int64_t amount;
+    };
+    const size_t NUM = 200000;
+    Vector<Sale> sales;
+    std::map<uint32_t, std::tuple<int64_t, size_t, int64_t, int64_t>> expected;
+    for (size_t i = 0; i < NUM; ++i) {
+        const Sale sale{ static_cast<uint32_t>((i * 7919) % 5003), static_cast<int64_t>(i % 1000) - 300 };
+        sales.PushBack(sale);
+        auto [it, inserted] = expected.try_emplace(sale.store, 0, 0, sale.amount, sale.amount);
+        auto& [sum, count, min, max] = it->second;
+        sum += sale.amount;
+        ++count;
+        min = std::min(min, sale.amount);
+        max = std::max(max, sale.amount);
+    }
+    const auto store_of = [](const Sale& sale) { return sale.store; };
+    const auto amount_of = [](const Sale& sale) { return sale.amount; };
+
+    const PartitionedVector<Sale> partitioned = RadixPartition(sales, store_of, 6, 4);
+    assert(partitioned.PartitionCount() == 64 && partitioned.items.Size() == NUM);
+    int64_t total = 0;
+    for (size_t p = 0; p < partitioned.PartitionCount(); ++p) {
+        for (const Sale* sale = partitioned.PartitionBegin(p); sale != partitioned.PartitionEnd(p); ++sale) {
+            assert((partition_detail::Mix(sale->store) >> 58) == p);
+            total += sale->amount;
+        }
+    }
+    assert(total == std::accumulate(sales.begin(), sales.end(), int64_t{ 0 },
+        [](int64_t acc, const Sale& sale) { return acc + sale.amount; }));
+
+    const auto sums = GroupBySum(sales, store_of, amount_of, 4);
+    const auto counts = GroupByCount(sales, store_of, 4);
+    const auto mins = GroupByMin(sales, store_of, amount_of, 4);
+    const auto maxes = GroupByMax(sales, store_of, amount_of);
+    assert(sums.Size() == expected.size() && counts.Size() == expected.size());
+    for (const auto& [store, sum] : sums) {
+        assert(std::get<0>(expected.at(store)) == sum);
+    }
+    for (const auto& [store, count] : counts) {
+        assert(std::get<1>(expected.at(store)) == count);
+    }
+    for (const auto& [store, min] : mins) {
+        assert(std::get<2>(expected.at(store)) == min);
+    }
+    for (const auto& [store, max] : maxes) {
+        assert(std::get<3>(expected.at(store)) == max);
+    }
+
+    Vector<uint64_t> wide(NUM);
+    std::iota(wide.begin(), wide.end(), uint64_t{ 0 });
+    const auto wide_counts = GroupByCount(wide, [](uint64_t value) { return value / 4; }, 3);
+    assert(wide_counts.Size() == NUM / 4);
+    for (const auto& [key, count] : wide_counts) {
+        assert(key < NUM / 4 && count == 4);
+    }
+
+    // Thread 0 outgrows its direct table only near the end of its slice, so
+    // its partial groups must be carried into the partitioned pass.
+    Vector<uint64_t> late(NUM);
+    for (size_t i = 0; i < NUM; ++i) {
+        late[i] = i < NUM / 4 ? i % 7 : i;
+    }
+    late[1] = std::numeric_limits<uint64_t>::max();
+    late[NUM - 1] = std::numeric_limits<uint64_t>::max();
+    const auto late_sums = GroupBySum(late, [](uint64_t value) { return value; }, [](uint64_t) { return uint64_t{ 1 }; }, 2);
+    assert(late_sums.Size() == NUM - NUM / 4 + 7);
+    uint64_t late_total = 0;
+    for (const auto& [key, count] : late_sums) {
+        assert(key == std::numeric_limits<uint64_t>::max() ? count == 2 : key < 7 ? count > 1 : count == 1);
+        late_total += count;
+    }
+    assert(late_total == NUM);
+}
+
+void Test28() {
+    using namespace std::literals;
+    DictVector<std::string> column;
+    assert(column.Size() == 0 && column.Find("x"s) == DictVector<std::string>::kNoCode);
+    const std::string cities[] = { "Oslo"s, "Lima"s, "Kyiv"s, "Oslo"s, "Lima"s, "Oslo"s };
+    column.Append(std::begin(cities), std::end(cities));
+    assert(column.Size() == 6 && column.DictionarySize() == 3 && column.CodeWidth() == 1);
+    assert(column.CodeAt(0) == 0 && column.CodeAt(3) == 0 && column.CodeAt(2) == 2);
+    assert(column[4] == "Lima"s && column.Count("Oslo"s) == 3 && column.Count("Rome"s) == 0);
+    const Vector<size_t> oslo = column.Where("Oslo"s);
+    assert(oslo.Size() == 3 && oslo[0] == 0 && oslo[1] == 3 && oslo[2] == 5);
+    const Vector<size_t> counts = column.CountByCode();
+    assert(counts.Size() == 3 && counts[0] == 3 && counts[1] == 2 && counts[2] == 1);
+    const Vector<size_t> index_sums = column.AggregateByCode(size_t{ 0 }, [](size_t& acc, size_t i) { acc += i; });
+    assert(index_sums[0] == 8 && index_sums[1] == 5 && index_sums[2] == 2);
+    column.Set(2, "Oslo"s);
+    assert(column.Count("Oslo"s) == 4 && column.DictionarySize() == 3);
+
+    DictVector<uint32_t> wide;
+    for (uint32_t i = 0; i < 70000; ++i) {
+        wide.PushBack(i % 300);
+        if (i == 255) {
+            assert(wide.CodeWidth() == 1);
+        }
+    }
+    assert(wide.CodeWidth() == 2 && wide.DictionarySize() == 300);
+    for (uint32_t i = 0; i < 70000; ++i) {
+        wide.PushBack(i);
+    }
+    assert(wide.CodeWidth() == 4 && wide.DictionarySize() == 70000 && wide.Size() == 140000);
+    const Vector<uint32_t> decoded = wide.Decode();
+    for (uint32_t i = 0; i < 70000; ++i) {
+        assert(decoded[i] == i % 300 && decoded[70000 + i] == i && wide[i] == i % 300);
+    }
+    assert(wide.Count(299) == 234 && wide.Where(69999).Size() == 1);
+    wide.Clear();
+    assert(wide.Size() == 0 && wide.Find(12345) == 12345);
+}
+
+// Element constructed and destroyed from several threads at once.
+struct Counted {
+    Counted() {
+        if (throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
+    Counted(const Counted&) {
+        ++alive;
+    }
+    ~Counted() {
+        --alive;
+    }
+
+    inline static std::atomic<int> alive = 0;
+    inline static std::atomic<int> throw_countdown = 0;
+};
+
+void Test29() {
+    ParallelInit options;
+    options.threads = 4;
+    options.min_parallel_bytes = 0;
+    for (const PagePlacement placement : { PagePlacement::kFirstTouch, PagePlacement::kInterleave }) {
+        options.placement = placement;
+        const Vector<uint64_t> zeros = MakeVectorParallel<uint64_t>(1 << 20, options);
+        assert(zeros.Size() == 1 << 20);
+        assert(std::all_of(zeros.begin(), zeros.end(), [](uint64_t value) { return value == 0; }));
+        const Vector<size_t> nodes = PagesPerNode(zeros.Data(), zeros.Size() * sizeof(uint64_t));
+        assert(std::accumulate(nodes.begin(), nodes.end(), size_t{ 0 }) <= zeros.Size() * sizeof(uint64_t) / 4096 + 1);
+    }
+
+    Vector<std::string> words;
+    for (size_t i = 0; i < 100000; ++i) {
+        words.PushBack("a string long enough to live on the heap #" + std::to_string(i));
+    }
+    Vector<std::string> copy = CopyParallel(words, options);
+    assert(copy.Size() == words.Size() && std::equal(copy.begin(), copy.end(), words.begin()));
+    DestroyParallel(copy, options);
+    assert(copy.Size() == 0 && copy.Capacity() == 0);
+    assert(MakeVectorParallel<std::string>(0, options).Size() == 0);
+
+    {
+        const size_t SIZE = 100000;
+        Counted::alive = 0;
+        Counted::throw_countdown = SIZE / 2;
+        Vector<Counted> objects;
+        try {
+            objects = MakeVectorParallel<Counted>(SIZE, options);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(objects.Size() == 0 && Counted::alive == 0);
+
+        Counted::throw_countdown = 0;
+        objects = MakeVectorParallel<Counted>(SIZE, options);
+        assert(Counted::alive == static_cast<int>(SIZE));
+        DestroyParallel(objects, options);
+        assert(objects.Size() == 0 && Counted::alive == 0);
+    }
+}
+
+void Test30() {
+    TraceRecorder recorder;
+    size_t reallocations = 0;
+    {
+        Vector<int> values;
+        values.SetTraceRecorder(&recorder);
+        size_t capacity = values.Capacity();
+        const auto note = [&]() {
+            if (values.Capacity() != capacity) {
+                ++reallocations;
+                capacity = values.Capacity();
+            }
+        };
+        for (int i = 0; i < 100; ++i) {
+            values.PushBack(i);
+            note();
+        }
+        values.Insert(values.begin() + 10, -1);
+        values.Erase(values.begin() + 3);
+        values.PopBack();
+        values.Reserve(500);
+        note();
+        Vector<int> copy = values;
+        copy.Resize(10);
+        values.ShrinkToFit();
+        note();
+        values.Clear();
+    }
+    const Vector<TraceEvent> events = DecodeTrace(recorder.Bytes());
+    assert(events.Size() == recorder.EventCount() && recorder.Dropped() == 0);
+    assert(events[0].op == TraceOp::kCreate && events[0].vector == 0 && events[0].arg == sizeof(int));
+    const auto count_of = [&events](TraceOp op) {
+        return std::count_if(events.begin(), events.end(), [op](const TraceEvent& event) { return event.op == op; });
+    };
+    assert(count_of(TraceOp::kPushBack) == 100 && count_of(TraceOp::kDestroy) == 2);
+    assert(std::any_of(events.begin(), events.end(), [](const TraceEvent& event) {
+        return event.op == TraceOp::kInsert && event.arg == 10;
+        }));
+    assert(std::any_of(events.begin(), events.end(), [](const TraceEvent& event) {
+        return event.op == TraceOp::kCopy && event.vector == 1 && event.arg == 0;
+        }));
+
+    const ReplayStats vector_stats = ReplayTrace<VectorReplay>(events);
+    assert(vector_stats.operations == events.Size() && vector_stats.skipped == 0);
+    assert(vector_stats.reallocations == reallocations);
+    assert(vector_stats.peak_bytes == (500 + 99) * sizeof(int));
+    const ReplayStats growth_stats = ReplayTrace<GrowthReplay<3, 2>>(events);
+    assert(growth_stats.skipped == 0 && growth_stats.reallocations > vector_stats.reallocations);
+    const ReplayStats std_stats = ReplayTrace<StdVectorReplay>(events);
+    assert(std_stats.skipped == 0 && std_stats.reallocations > 0);
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "vector_trace_test.bin";
+    assert(recorder.Save(path.string().c_str()));
+    Vector<TraceEvent> loaded;
+    assert(LoadTrace(path.string().c_str(), loaded) && loaded.Size() == events.Size());
+    for (size_t i = 0; i < loaded.Size(); ++i) {
+        assert(loaded[i].op == events[i].op && loaded[i].vector == events[i].vector && loaded[i].arg == events[i].arg);
+    }
+    std::filesystem::remove(path);
+}
+
 struct C {
     C() noexcept {
         ++def_ctor;
@@ -617,31 +2052,48 @@ void Dump() {
 
 void Benchmark() {
     using namespace std;
+    PerfCounters counters;
     try {
         const size_t NUM = 10;
         C c;
+        PerfSample construction;
+        PerfSample push_back;
         {
             cerr << "std::vector:"sv << endl;
             C::Reset();
+            counters.Start();
             vector<C> v(NUM);
+            construction = counters.Stop();
             Dump();
+            counters.Start();
             v.push_back(c);
+            push_back = counters.Stop();
         }
         Dump();
+        PrintPerfSample(cerr, "Construction counters"sv, construction, NUM);
+        PrintPerfSample(cerr, "PushBack counters"sv, push_back, 1);
     }
     catch (...) {
     }
     try {
         const size_t NUM = 10;
         C c;
+        PerfSample construction;
+        PerfSample push_back;
         {
             cerr << "Vector:"sv << endl;
             C::Reset();
+            counters.Start();
             Vector<C> v(NUM);
+            construction = counters.Stop();
             Dump();
+            counters.Start();
             v.PushBack(c);
+            push_back = counters.Stop();
         }
         Dump();
+        PrintPerfSample(cerr, "Construction counters"sv, construction, NUM);
+        PrintPerfSample(cerr, "PushBack counters"sv, push_back, 1);
     }
     catch (...) {
     }
@@ -656,6 +2108,30 @@ void TestsForVector()
         Test4();
         Test5();
         Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
         Benchmark();
     }
     catch (const std::exception& e) {
@@ -0,0 +1,337 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "vector.h"
+#include "vector_trace.h"
+
+struct ReplayStats
+{
+    size_t operations = 0;
+    // Events naming an unknown vector or an out of range position.
+    size_t skipped = 0;
+    size_t reallocations = 0;
+    // Largest total capacity of the live vectors, in recorded element sizes.
+    size_t peak_bytes = 0;
+    double milliseconds = 0;
+    // Folds in the bytes kRead events touched, so the reads are not optimized away.
+    unsigned char checksum = 0;
+};
+
+// Stand-in for the recorded element types, which the trace only knows by size.
+template <size_t N>
+struct ReplayElement
+{
+    unsigned char bytes[N];
+};
+
+namespace trace_replay_detail
+{
+    template <typename E> size_t Size(const Vector<E>& c) noexcept { return c.Size(); }
+    template <typename E> size_t Capacity(const Vector<E>& c) noexcept { return c.Capacity(); }
+    template <typename E> void Reserve(Vector<E>& c, size_t n) { c.Reserve(n); }
+    template <typename E> void Resize(Vector<E>& c, size_t n) { c.Resize(n); }
+    template <typename E> void PushBack(Vector<E>& c) { c.EmplaceBack(); }
+    template <typename E> void PopBack(Vector<E>& c) { c.PopBack(); }
+    template <typename E> void Insert(Vector<E>& c, size_t pos) { c.Emplace(c.begin() + pos); }
+    template <typename E> void Erase(Vector<E>& c, size_t pos) { c.Erase(c.begin() + pos); }
+    template <typename E> void Clear(Vector<E>& c) { c.Clear(); }
+    template <typename E> void ClearAndTrim(Vector<E>& c) { c.ClearAndTrim(); }
+    template <typename E> void ShrinkToFit(Vector<E>& c) { c.ShrinkToFit(); }
+    template <typename E> unsigned char Read(const Vector<E>& c, size_t i) { return c[i].bytes[0]; }
+
+    template <typename E, typename A> size_t Size(const std::vector<E, A>& c) noexcept { return c.size(); }
+    template <typename E, typename A> size_t Capacity(const std::vector<E, A>& c) noexcept { return c.capacity(); }
+    template <typename E, typename A> void Reserve(std::vector<E, A>& c, size_t n) { c.reserve(n); }
+    template <typename E, typename A> void Resize(std::vector<E, A>& c, size_t n) { c.resize(n); }
+    template <typename E, typename A> void PushBack(std::vector<E, A>& c) { c.emplace_back(); }
+    template <typename E, typename A> void PopBack(std::vector<E, A>& c) { c.pop_back(); }
+    template <typename E, typename A> void Insert(std::vector<E, A>& c, size_t pos) { c.emplace(c.begin() + pos); }
+    template <typename E, typename A> void Erase(std::vector<E, A>& c, size_t pos) { c.erase(c.begin() + pos); }
+    template <typename E, typename A> void Clear(std::vector<E, A>& c) { c.clear(); }
+    template <typename E, typename A> void ClearAndTrim(std::vector<E, A>& c) { std::vector<E, A>().swap(c); }
+    template <typename E, typename A> void ShrinkToFit(std::vector<E, A>& c) { c.shrink_to_fit(); }
+    template <typename E, typename A> unsigned char Read(const std::vector<E, A>& c, size_t i) { return c[i].bytes[0]; }
+
+    template <typename Target, size_t... Sizes>
+    using SlotOf = std::variant<std::monostate, typename Target::template Container<ReplayElement<Sizes>>...>;
+
+    // Element sizes are rounded up to a power of two, at most 256 bytes.
+    template <typename Target>
+    using Slot = SlotOf<Target, 1, 2, 4, 8, 16, 32, 64, 128, 256>;
+
+    inline size_t SizeClass(size_t element_size) noexcept
+    {
+        size_t index = 0;
+        while (index < 8 && (size_t(1) << index) < element_size)
+        {
+            ++index;
+        }
+        return index + 1;
+    }
+
+    template <typename Target, size_t... I>
+    void Create(Slot<Target>& slot, size_t index, std::index_sequence<I...>)
+    {
+        ((index == I ? (void)slot.template emplace<I>() : (void)0), ...);
+    }
+}
+
+// Replay targets. Container<E> is the container under test, Configure runs on
+// every container the replay creates and BeforeGrow before every PushBack or
+// Insert, which is where a target can impose its own growth policy.
+struct VectorReplay
+{
+    template <typename E>
+    using Container = Vector<E>;
+
+    template <typename C>
+    static void Configure(C&) noexcept
+    {}
+
+    template <typename C>
+    static void BeforeGrow(C&)
+    {}
+};
+
+struct StdVectorReplay : VectorReplay
+{
+    template <typename E>
+    using Container = std::vector<E>;
+};
+
+// Grows a full Vector by Num / Den instead of doubling.
+template <size_t Num, size_t Den>
+struct GrowthReplay : VectorReplay
+{
+    static_assert(Num > Den, "the growth factor must exceed 1");
+
+    template <typename C>
+    static void BeforeGrow(C& c)
+    {
+        using namespace trace_replay_detail;
+        if (Size(c) == Capacity(c))
+        {
+            Reserve(c, std::max(Capacity(c) * Num / Den, Capacity(c) + 1));
+        }
+    }
+};
+
+template <size_t Window, size_t UsagePercent = 25>
+struct DecayReplay : VectorReplay
+{
+    template <typename C>
+    static void Configure(C& c) noexcept
+    {
+        c.SetDecayPolicy(DecayPolicy{ Window, UsagePercent });
+    }
+};
+
+// Decodes a recorded byte stream, stopping at the first malformed event.
+inline Vector<TraceEvent> DecodeTrace(const std::vector<unsigned char>& bytes)
+{
+    Vector<TraceEvent> events;
+    const unsigned char* pos = bytes.data();
+    const unsigned char* end = pos + bytes.size();
+    TraceEvent event;
+    while (DecodeTraceEvent(pos, end, event))
+    {
+        events.PushBack(event);
+    }
+    return events;
+}
+
+inline bool LoadTrace(const char* path, Vector<TraceEvent>& events)
+{
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char chunk[1 << 16];
+    size_t read = 0;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) != 0)
+    {
+        bytes.insert(bytes.end(), chunk, chunk + read);
+    }
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed)
+    {
+        return false;
+    }
+    events = DecodeTrace(bytes);
+    return true;
+}
+
+// Reruns the recorded operations against Target's containers.
+template <typename Target>
+ReplayStats ReplayTrace(const Vector<TraceEvent>& events)
+{
+    using namespace trace_replay_detail;
+    struct Live
+    {
+        Slot<Target> slot;
+        size_t element_size = 0;
+        size_t capacity = 0;
+    };
+
+    ReplayStats stats;
+    std::vector<Live> live;
+    size_t bytes = 0;
+    unsigned char checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const TraceEvent& event : events)
+    {
+        ++stats.operations;
+        if (event.op == TraceOp::kCreate || event.op == TraceOp::kCopy)
+        {
+            if (live.size() <= event.vector)
+            {
+                live.resize(event.vector + size_t(1));
+            }
+            Live& created = live[event.vector];
+            if (event.op == TraceOp::kCreate)
+            {
+                created.element_size = static_cast<size_t>(event.arg);
+                Create<Target>(created.slot, SizeClass(created.element_size), std::make_index_sequence<10>());
+            }
+            else if (event.arg < live.size() && live[event.arg].slot.index() != 0)
+            {
+                created.element_size = live[event.arg].element_size;
+                created.slot = live[event.arg].slot;
+            }
+            else
+            {
+                ++stats.skipped;
+                continue;
+            }
+            std::visit([&](auto& c) {
+                if constexpr (!std::is_same_v<std::decay_t<decltype(c)>, std::monostate>)
+                {
+                    Target::Configure(c);
+                    created.capacity = Capacity(c);
+                }
+                }, created.slot);
+            bytes += created.capacity * created.element_size;
+            stats.peak_bytes = std::max(stats.peak_bytes, bytes);
+            continue;
+        }
+        if (event.vector >= live.size() || live[event.vector].slot.index() == 0)
+        {
+            ++stats.skipped;
+            continue;
+        }
+        Live& target = live[event.vector];
+        if (event.op == TraceOp::kDestroy)
+        {
+            bytes -= target.capacity * target.element_size;
+            target.slot.template emplace<0>();
+            target.capacity = 0;
+            continue;
+        }
+        const size_t arg = static_cast<size_t>(event.arg);
+        std::visit([&](auto& c) {
+            using C = std::decay_t<decltype(c)>;
+            if constexpr (!std::is_same_v<C, std::monostate>)
+            {
+                switch (event.op)
+                {
+                case TraceOp::kAssign:
+                {
+                    C source;
+                    Target::Configure(source);
+                    Resize(source, arg);
+                    c = source;
+                    break;
+                }
+                case TraceOp::kReserve:
+                    Reserve(c, arg);
+                    break;
+                case TraceOp::kResize:
+                    Resize(c, arg);
+                    break;
+                case TraceOp::kPushBack:
+                    Target::BeforeGrow(c);
+                    PushBack(c);
+                    break;
+                case TraceOp::kPopBack:
+                    Size(c) != 0 ? PopBack(c) : (void)++stats.skipped;
+                    break;
+                case TraceOp::kInsert:
+                    if (arg <= Size(c))
+                    {
+                        Target::BeforeGrow(c);
+                        Insert(c, arg);
+                    }
+                    else
+                    {
+                        ++stats.skipped;
+                    }
+                    break;
+                case TraceOp::kErase:
+                    arg < Size(c) ? Erase(c, arg) : (void)++stats.skipped;
+                    break;
+                case TraceOp::kClear:
+                    Clear(c);
+                    break;
+                case TraceOp::kClearAndTrim:
+                    ClearAndTrim(c);
+                    break;
+                case TraceOp::kShrinkToFit:
+                    ShrinkToFit(c);
+                    break;
+                case TraceOp::kRead:
+                    arg < Size(c) ? (void)(checksum ^= Read(c, arg)) : (void)++stats.skipped;
+                    break;
+                default:
+                    ++stats.skipped;
+                    break;
+                }
+                const size_t capacity = Capacity(c);
+                if (capacity != target.capacity)
+                {
+                    stats.reallocations += capacity != 0 ? 1 : 0;
+                    bytes = bytes - target.capacity * target.element_size + capacity * target.element_size;
+                    stats.peak_bytes = std::max(stats.peak_bytes, bytes);
+                    target.capacity = capacity;
+                }
+            }
+            }, target.slot);
+    }
+    live.clear();
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.checksum = checksum;
+    return stats;
+}
+
+inline void PrintReplayStats(std::ostream& out, std::string_view name, const ReplayStats& stats)
+{
+    using namespace std::literals;
+    out << name << ": "sv << stats.milliseconds << " ms, peak "sv << stats.peak_bytes << " bytes, "sv
+        << stats.reallocations << " reallocations, "sv << stats.operations << " operations"sv;
+    if (stats.skipped != 0)
+    {
+        out << " ("sv << stats.skipped << " skipped)"sv;
+    }
+    out << std::endl;
+}
+
+// Replays events against the stock configurations and prints one line each.
+inline void CompareReplays(std::ostream& out, const Vector<TraceEvent>& events)
+{
+    using namespace std::literals;
+    PrintReplayStats(out, "Vector"sv, ReplayTrace<VectorReplay>(events));
+    PrintReplayStats(out, "Vector, 1.5x growth"sv, ReplayTrace<GrowthReplay<3, 2>>(events));
+    PrintReplayStats(out, "Vector, capacity decay"sv, ReplayTrace<DecayReplay<8>>(events));
+    PrintReplayStats(out, "std::vector"sv, ReplayTrace<StdVectorReplay>(events));
+}
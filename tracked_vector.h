@@ -0,0 +1,337 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+#include "vector.h"
+
+// A run of modified elements: data points into the tracked vector and stays
+// valid until the next modification.
+template <typename T>
+struct DirtyPatch
+{
+    size_t offset = 0;
+    const T* data = nullptr;
+    size_t count = 0;
+};
+
+// Everything a replica needs to catch up: the new size plus changed runs.
+template <typename T>
+struct DirtySet
+{
+    size_t size = 0;
+    Vector<DirtyPatch<T>> patches;
+
+    size_t DirtyElements() const noexcept
+    {
+        size_t total = 0;
+        for (const DirtyPatch<T>& patch : patches)
+        {
+            total += patch.count;
+        }
+        return total;
+    }
+};
+
+// A Vector that remembers which blocks of BlockElements() elements changed
+// since the last CollectDirty(), one bit per block. By default a block is
+// 4 KiB worth of elements. Mutable operator[] marks its block on access, so
+// hand out references only for elements that are really written.
+template <typename T>
+class TrackedVector
+{
+public:
+    using const_iterator = const T*;
+
+    explicit TrackedVector(size_t block_elements = DefaultBlockElements());
+    // Starts fully dirty, so the first CollectDirty() is a full copy.
+    explicit TrackedVector(Vector<T> values, size_t block_elements = DefaultBlockElements());
+
+    static constexpr size_t DefaultBlockElements() noexcept
+    {
+        return sizeof(T) >= 4096 ? 1 : 4096 / sizeof(T);
+    }
+
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+    size_t BlockElements() const noexcept;
+    const Vector<T>& Items() const noexcept;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    void Reserve(size_t capacity);
+    void Resize(size_t size);
+
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args);
+    void PopBack();
+
+    // Elements from index on shift, so their blocks are all marked.
+    void Insert(size_t index, const T& value);
+    void Insert(size_t index, T&& value);
+    void Erase(size_t index);
+
+    void Set(size_t index, T value);
+
+    // Returns patches for the blocks touched since the last call and resets
+    // the tracking. Adjacent dirty blocks come back as a single patch.
+    DirtySet<T> CollectDirty();
+    void MarkAllDirty();
+
+    const T& operator[](size_t index) const noexcept;
+    T& operator[](size_t index);
+
+private:
+    void MarkRange(size_t first, size_t last);
+    void MarkIndex(size_t index);
+    void EnsureBlock(size_t block);
+
+    Vector<T> items_;
+    Vector<uint64_t> dirty_;
+    size_t block_elements_;
+};
+
+// Brings replica in line with the source the patches were collected from.
+template <typename T>
+void ApplyPatches(Vector<T>& replica, const DirtySet<T>& changes)
+{
+    replica.Resize(changes.size);
+    for (const DirtyPatch<T>& patch : changes.patches)
+    {
+        assert(patch.offset + patch.count <= replica.Size());
+        std::copy_n(patch.data, patch.count, replica.begin() + patch.offset);
+    }
+}
+
+//----------------------------TrackedVector------------------------------------------------
+
+template<typename T>
+inline TrackedVector<T>::TrackedVector(size_t block_elements)
+    : block_elements_(std::max<size_t>(block_elements, 1))
+{}
+
+template<typename T>
+inline TrackedVector<T>::TrackedVector(Vector<T> values, size_t block_elements)
+    : block_elements_(std::max<size_t>(block_elements, 1))
+{
+    items_.Swap(values);
+    MarkAllDirty();
+}
+
+template<typename T>
+inline size_t TrackedVector<T>::Size() const noexcept
+{
+    return items_.Size();
+}
+
+template<typename T>
+inline size_t TrackedVector<T>::Capacity() const noexcept
+{
+    return items_.Capacity();
+}
+
+template<typename T>
+inline size_t TrackedVector<T>::BlockElements() const noexcept
+{
+    return block_elements_;
+}
+
+template<typename T>
+inline const Vector<T>& TrackedVector<T>::Items() const noexcept
+{
+    return items_;
+}
+
+template<typename T>
+inline typename TrackedVector<T>::const_iterator TrackedVector<T>::begin() const noexcept
+{
+    return items_.begin();
+}
+
+template<typename T>
+inline typename TrackedVector<T>::const_iterator TrackedVector<T>::end() const noexcept
+{
+    return items_.end();
+}
+
+template<typename T>
+inline void TrackedVector<T>::Reserve(size_t capacity)
+{
+    items_.Reserve(capacity);
+}
+
+template<typename T>
+inline void TrackedVector<T>::Resize(size_t size)
+{
+    const size_t old_size = items_.Size();
+    items_.Resize(size);
+    if (size > old_size)
+    {
+        MarkRange(old_size, size);
+    }
+}
+
+template<typename T>
+inline void TrackedVector<T>::PushBack(const T& value)
+{
+    EmplaceBack(value);
+}
+
+template<typename T>
+inline void TrackedVector<T>::PushBack(T&& value)
+{
+    EmplaceBack(std::move(value));
+}
+
+template<typename T>
+template<typename ...Args>
+inline T& TrackedVector<T>::EmplaceBack(Args && ...args)
+{
+    T& result = items_.EmplaceBack(std::forward<Args>(args)...);
+    MarkIndex(items_.Size() - 1);
+    return result;
+}
+
+template<typename T>
+inline void TrackedVector<T>::PopBack()
+{
+    items_.PopBack();
+}
+
+template<typename T>
+inline void TrackedVector<T>::Insert(size_t index, const T& value)
+{
+    assert(index <= items_.Size());
+    items_.Insert(items_.begin() + index, value);
+    MarkRange(index, items_.Size());
+}
+
+template<typename T>
+inline void TrackedVector<T>::Insert(size_t index, T&& value)
+{
+    assert(index <= items_.Size());
+    items_.Insert(items_.begin() + index, std::move(value));
+    MarkRange(index, items_.Size());
+}
+
+template<typename T>
+inline void TrackedVector<T>::Erase(size_t index)
+{
+    assert(index < items_.Size());
+    items_.Erase(items_.begin() + index);
+    MarkRange(index, items_.Size());
+}
+
+template<typename T>
+inline void TrackedVector<T>::Set(size_t index, T value)
+{
+    assert(index < items_.Size());
+    items_[index] = std::move(value);
+    MarkIndex(index);
+}
+
+template<typename T>
+inline DirtySet<T> TrackedVector<T>::CollectDirty()
+{
+    DirtySet<T> result;
+    result.size = items_.Size();
+    const size_t blocks = (items_.Size() + block_elements_ - 1) / block_elements_;
+    size_t run_start = 0;
+    bool in_run = false;
+    const auto close_run = [&](size_t run_end) {
+        const size_t first = run_start * block_elements_;
+        const size_t last = std::min(run_end * block_elements_, items_.Size());
+        result.patches.PushBack({ first, items_.begin() + first, last - first });
+        in_run = false;
+    };
+    for (size_t word = 0; word < dirty_.Size(); ++word)
+    {
+        uint64_t bits = std::exchange(dirty_[word], 0);
+        if (bits == 0 && !in_run)
+        {
+            continue;
+        }
+        for (size_t bit = 0; bit < 64; ++bit)
+        {
+            const size_t block = word * 64 + bit;
+            if (block >= blocks)
+            {
+                break;
+            }
+            const bool dirty = (bits >> bit) & 1;
+            if (dirty && !in_run)
+            {
+                run_start = block;
+                in_run = true;
+            }
+            else if (!dirty && in_run)
+            {
+                close_run(block);
+            }
+        }
+    }
+    if (in_run)
+    {
+        close_run(blocks);
+    }
+    return result;
+}
+
+template<typename T>
+inline void TrackedVector<T>::MarkAllDirty()
+{
+    MarkRange(0, items_.Size());
+}
+
+template<typename T>
+inline const T& TrackedVector<T>::operator[](size_t index) const noexcept
+{
+    return items_[index];
+}
+
+template<typename T>
+inline T& TrackedVector<T>::operator[](size_t index)
+{
+    assert(index < items_.Size());
+    MarkIndex(index);
+    return items_[index];
+}
+
+template<typename T>
+inline void TrackedVector<T>::MarkRange(size_t first, size_t last)
+{
+    if (first >= last)
+    {
+        return;
+    }
+    const size_t first_block = first / block_elements_;
+    const size_t last_block = (last - 1) / block_elements_;
+    EnsureBlock(last_block);
+    for (size_t block = first_block; block <= last_block; ++block)
+    {
+        dirty_[block / 64] |= uint64_t{ 1 } << (block % 64);
+    }
+}
+
+template<typename T>
+inline void TrackedVector<T>::MarkIndex(size_t index)
+{
+    const size_t block = index / block_elements_;
+    EnsureBlock(block);
+    dirty_[block / 64] |= uint64_t{ 1 } << (block % 64);
+}
+
+template<typename T>
+inline void TrackedVector<T>::EnsureBlock(size_t block)
+{
+    const size_t words = block / 64 + 1;
+    if (dirty_.Size() < words)
+    {
+        dirty_.Reserve(std::max(words, dirty_.Capacity() * 2));
+        dirty_.Resize(words);
+    }
+}
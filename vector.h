@@ -1,18 +1,88 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <new>
 #include <utility>
 #include <memory>
 
+#if __cplusplus > 201703L && __has_include(<span>)
+#include <span>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "memory_budget.h"
+#include "memory_footprint.h"
+#include "vector_probes.h"
+#include "vector_trace.h"
+
+// Frees a buffer handed over by Vector::Release or into Vector::Adopt. It only
+// returns the storage; live elements are destroyed before it is called.
 template <typename T>
+struct BufferDeleter
+{
+    using FreeFunction = void (*)(void* context, T* data, size_t capacity);
+
+    FreeFunction free_function = nullptr;
+    void* context = nullptr;
+
+    // For buffers from std::malloc, e.g. handed over by a C library.
+    static BufferDeleter StdFree() noexcept
+    {
+        return { [](void*, T* data, size_t) { std::free(data); }, nullptr };
+    }
+
+    void operator()(T* data, size_t capacity) const
+    {
+        if (free_function != nullptr)
+        {
+            free_function(context, data, capacity);
+        }
+    }
+};
+
+// Contents given up by Vector::Release: elements [0, size) are alive.
+template <typename T>
+struct ReleasedBuffer
+{
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+    BufferDeleter<T> deleter;
+
+    // Destroys the elements and frees the storage.
+    void Dispose() noexcept
+    {
+        std::destroy_n(data, size);
+        deleter(data, capacity);
+        data = nullptr;
+        size = 0;
+        capacity = 0;
+    }
+};
+
+// Uninitialized storage for `capacity` objects of type T. The buffer is
+// aligned to Alignment, which may exceed alignof(T) (for example a cache line).
+template <typename T, size_t Alignment = alignof(T)>
 class RawMemory
 {
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two no smaller than alignof(T)");
+
 public:
     RawMemory() = default;
 
     explicit RawMemory(size_t capacity);       
 
+    // Charges the buffer to budget (if any); throws std::bad_alloc when the budget is exhausted.
+    RawMemory(size_t capacity, MemoryBudget* budget);
+
+    // Reports failure instead of throwing; on success out holds the new buffer.
+    static AllocStatus TryCreate(size_t capacity, MemoryBudget* budget, RawMemory& out) noexcept;
+
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
 
@@ -34,13 +104,46 @@ public:
 
     size_t Capacity() const;   
 
+    MemoryBudget* Budget() const noexcept;
+
+    // Moves the charge for the current buffer from the old budget to the new one.
+    void SetBudget(MemoryBudget* budget) noexcept;
+
+    // Gives up the buffer without freeing it; deleter receives how to free it.
+    T* Release(BufferDeleter<T>& deleter) noexcept;
+
+    // Frees the current buffer and takes ownership of buffer.
+    void Adopt(T* buffer, size_t capacity, BufferDeleter<T> deleter) noexcept;
+
+    // Returns the whole pages past the first `used` elements to the OS while
+    // keeping the address range; they read back as zeroes. Only done for large
+    // buffers this class allocated itself, and only on Linux.
+    bool DiscardUnused(size_t used) noexcept;
+
+    static constexpr size_t kDiscardThresholdBytes = size_t(256) << 10;
+
 private:
    
-    static T* Allocate(size_t n) noexcept;      
-    static void Deallocate(T* buf) noexcept;  
+    static T* Allocate(size_t n);      
+    static T* TryAllocate(size_t n) noexcept;
+    static void Deallocate(T* buf, size_t capacity) noexcept;  
+    static bool ChargeBudget(MemoryBudget* budget, size_t bytes) noexcept;
+    static void FreeAllocated(void* context, T* buf, size_t capacity) noexcept;
+    void Free() noexcept;
 
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
+    MemoryBudget* budget_ = nullptr;
+    BufferDeleter<T> deleter_;
+};
+
+// Opt-in capacity decay: once `window` consecutive removals (PopBack, Erase,
+// shrinking Resize, Clear) leave the vector below `usage_percent` of its
+// capacity, the spare capacity is given back.
+struct DecayPolicy
+{
+    size_t window = 0;
+    size_t usage_percent = 25;
 };
 
 template <typename T>
@@ -67,18 +170,61 @@ public:
     const_iterator cbegin() const noexcept;
     const_iterator cend() const noexcept;  
 
-    void Reserve(size_t new_capacity) noexcept;    
+    void Reserve(size_t new_capacity);    
 
-    void Resize(size_t size) noexcept;    
+    void Resize(size_t size);    
 
-    void PushBack(const T& value) noexcept;    
+    void PushBack(const T& value);    
 
-    void PushBack(T&& value) noexcept;   
+    void PushBack(T&& value);   
 
     void PopBack();
 
+    // Destroys all elements and keeps the buffer for reuse (unless a decay
+    // policy decides otherwise).
+    void Clear() noexcept;
+
+    // Destroys all elements and frees the buffer.
+    void ClearAndTrim() noexcept;
+
+    // Reallocates so that Capacity() == Size().
+    void ShrinkToFit();
+
+    // Decay halves usage back to at most 2 * Size() by reallocating; buffers of
+    // kDiscardThresholdBytes and more keep their capacity but hand the unused
+    // pages back to the OS instead. A zero window turns decay off.
+    void SetDecayPolicy(DecayPolicy policy) noexcept;
+
+    // Logs this vector's operations to recorder from now on (nullptr stops).
+    // The trace identity travels with the contents through moves and Swap;
+    // copies of a traced vector are traced too. Element access is only logged
+    // when compiled with VECTOR_TRACE_INDEXING.
+    void SetTraceRecorder(TraceRecorder* recorder) noexcept;
+
     template<typename ... Args>
-    T& EmplaceBack(Args&&... args) noexcept;   
+    T& EmplaceBack(Args&&... args);   
+
+    // Fallible growth: an allocation failure or an exhausted budget is reported
+    // through the status and leaves the vector unchanged. Exceptions thrown by
+    // T's own constructors still propagate.
+    AllocStatus TryReserve(size_t new_capacity);
+
+    AllocStatus TryPushBack(const T& value);
+
+    AllocStatus TryPushBack(T&& value);
+
+    template<typename ... Args>
+    AllocStatus TryEmplaceBack(Args&&... args);
+
+    // Buffers allocated from now on are charged to budget, as is the current one.
+    void SetBudget(MemoryBudget* budget) noexcept;
+
+    MemoryBudget* Budget() const noexcept;
+
+    // Reserves room for max_count more elements and lets fill(dest, max_count)
+    // construct elements directly at dest; fill returns how many it built.
+    template <typename Fill>
+    size_t AppendInPlace(size_t max_count, Fill fill);
 
     template <typename... Args>
     iterator Emplace(const_iterator pos, Args&&... args);    
@@ -89,7 +235,7 @@ public:
 
     iterator Insert(const_iterator pos, T&& value);    
 
-    Vector& operator=(const Vector& rhs) noexcept;
+    Vector& operator=(const Vector& rhs);
     Vector& operator=(Vector&& rhs) noexcept;    
 
     void Swap(Vector& rhs) noexcept;   
@@ -98,86 +244,315 @@ public:
 
     size_t Capacity() const noexcept;    
 
+    Footprint MemoryFootprint() const noexcept;
+
+    T* Data() noexcept;
+    const T* Data() const noexcept;
+
+    // Hands the buffer and its elements to the caller, who must eventually
+    // Dispose() it; the vector is left empty.
+    ReleasedBuffer<T> Release() noexcept;
+
+    // Destroys the current contents and takes over data, whose first size
+    // elements must be alive; deleter frees it once the vector is done with it.
+    void Adopt(T* data, size_t size, size_t capacity, BufferDeleter<T> deleter) noexcept;
+
+#ifdef __cpp_lib_span
+    operator std::span<T>() noexcept;
+    operator std::span<const T>() const noexcept;
+#endif
+
     const T& operator[](size_t index) const noexcept;   
 
     T& operator[](size_t index) noexcept;
     
 
 private:
+    static void RelocateN(T* from, size_t count, T* to);
+
+    void NoteRemoval() noexcept;
+    void Decay() noexcept;
+    bool ReallocateExactly(size_t capacity);
+    void Trace(TraceOp op, uint64_t arg = 0) const noexcept;
+
     RawMemory<T> data_;
     size_t size_ = 0;
+    DecayPolicy decay_;
+    size_t decay_count_ = 0;
+    TraceRecorder* trace_ = nullptr;
+    uint32_t trace_id_ = 0;
 };
 
 //----------------------------RawMemory------------------------------------------------
 //------Costructer and destructor-----
 
-template<typename T>
-inline RawMemory<T>::RawMemory(size_t capacity)
+template<typename T, size_t Alignment>
+inline RawMemory<T, Alignment>::RawMemory(size_t capacity)
     : buffer_(Allocate(capacity))
     , capacity_(capacity)
 {}
 
-template<typename T>
-inline RawMemory<T>::RawMemory(RawMemory && other) noexcept
+template<typename T, size_t Alignment>
+inline RawMemory<T, Alignment>::RawMemory(size_t capacity, MemoryBudget* budget)
+    : budget_(budget)
 {
-    if (&buffer_ != &other.buffer_)
+    const size_t bytes = capacity * sizeof(T);
+    if (budget_ != nullptr && !ChargeBudget(budget_, bytes))
     {
-        Swap(other);
+        throw std::bad_alloc();
+    }
+    try
+    {
+        buffer_ = Allocate(capacity);
     }
+    catch (...)
+    {
+        if (budget_ != nullptr)
+        {
+            budget_->Release(bytes);
+        }
+        throw;
+    }
+    capacity_ = capacity;
 }
 
-template<typename T>
-inline RawMemory<T>::~RawMemory() noexcept
+template<typename T, size_t Alignment>
+inline AllocStatus RawMemory<T, Alignment>::TryCreate(size_t capacity, MemoryBudget* budget, RawMemory& out) noexcept
 {
-    if (buffer_ != nullptr)
+    if (capacity > static_cast<size_t>(-1) / sizeof(T))
+    {
+        return AllocStatus::kOutOfMemory;
+    }
+    const size_t bytes = capacity * sizeof(T);
+    if (budget != nullptr && !ChargeBudget(budget, bytes))
     {
-        Deallocate(buffer_);
+        return AllocStatus::kBudgetExceeded;
+    }
+    RawMemory result;
+    result.budget_ = budget;
+    if (capacity != 0)
+    {
+        result.buffer_ = TryAllocate(capacity);
+        if (result.buffer_ == nullptr && NotifyMemoryPressure(bytes, AllocStatus::kOutOfMemory))
+        {
+            result.buffer_ = TryAllocate(capacity);
+        }
+        if (result.buffer_ == nullptr)
+        {
+            if (budget != nullptr)
+            {
+                budget->Release(bytes);
+            }
+            result.budget_ = nullptr;
+            return AllocStatus::kOutOfMemory;
+        }
+    }
+    result.capacity_ = capacity;
+    out.Swap(result);
+    return AllocStatus::kOk;
+}
+
+template<typename T, size_t Alignment>
+inline RawMemory<T, Alignment>::RawMemory(RawMemory && other) noexcept
+{
+    if (&buffer_ != &other.buffer_)
+    {
+        Swap(other);
     }
 }
 
+template<typename T, size_t Alignment>
+inline RawMemory<T, Alignment>::~RawMemory() noexcept
+{
+    Free();
+}
+
 //------------Methods----------------
 
-template<typename T>
-inline void RawMemory<T>::Swap(RawMemory& other) noexcept
+template<typename T, size_t Alignment>
+inline void RawMemory<T, Alignment>::Swap(RawMemory& other) noexcept
 {
     std::swap(buffer_, other.buffer_);
     std::swap(capacity_, other.capacity_);
+    std::swap(budget_, other.budget_);
+    std::swap(deleter_, other.deleter_);
 }
 
-template<typename T>
-inline const T* RawMemory<T>::GetAddress() const noexcept
+template<typename T, size_t Alignment>
+inline const T* RawMemory<T, Alignment>::GetAddress() const noexcept
 {
     return buffer_;
 }
 
-template<typename T>
-inline T* RawMemory<T>::GetAddress() noexcept
+template<typename T, size_t Alignment>
+inline T* RawMemory<T, Alignment>::GetAddress() noexcept
 {
     return buffer_;
 }
 
-template<typename T>
-inline size_t RawMemory<T>::Capacity() const
+template<typename T, size_t Alignment>
+inline size_t RawMemory<T, Alignment>::Capacity() const
 {
     return capacity_;
 }
 
-template<typename T>
-inline T* RawMemory<T>::Allocate(size_t n) noexcept
+template<typename T, size_t Alignment>
+inline MemoryBudget* RawMemory<T, Alignment>::Budget() const noexcept
 {
-    return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    return budget_;
 }
 
-template<typename T>
-inline void RawMemory<T>::Deallocate(T* buf) noexcept
+template<typename T, size_t Alignment>
+inline void RawMemory<T, Alignment>::SetBudget(MemoryBudget* budget) noexcept
+{
+    if (budget_ != nullptr)
+    {
+        budget_->Release(capacity_ * sizeof(T));
+    }
+    budget_ = budget;
+    if (budget_ != nullptr)
+    {
+        budget_->Charge(capacity_ * sizeof(T));
+    }
+}
+
+template<typename T, size_t Alignment>
+inline T* RawMemory<T, Alignment>::Release(BufferDeleter<T>& deleter) noexcept
+{
+    deleter = deleter_.free_function != nullptr ? deleter_ : BufferDeleter<T>{ &FreeAllocated, nullptr };
+    if (budget_ != nullptr)
+    {
+        budget_->Release(capacity_ * sizeof(T));
+    }
+    T* buffer = std::exchange(buffer_, nullptr);
+    capacity_ = 0;
+    deleter_ = {};
+    return buffer;
+}
+
+template<typename T, size_t Alignment>
+inline void RawMemory<T, Alignment>::Adopt(T* buffer, size_t capacity, BufferDeleter<T> deleter) noexcept
+{
+    Free();
+    buffer_ = buffer;
+    capacity_ = capacity;
+    deleter_ = deleter;
+    if (budget_ != nullptr)
+    {
+        budget_->Charge(capacity_ * sizeof(T));
+    }
+}
+
+template<typename T, size_t Alignment>
+inline bool RawMemory<T, Alignment>::DiscardUnused([[maybe_unused]] size_t used) noexcept
+{
+#ifdef __linux__
+    if (buffer_ == nullptr || deleter_.free_function != nullptr || capacity_ * sizeof(T) < kDiscardThresholdBytes)
+    {
+        return false;
+    }
+    const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const uintptr_t start = (reinterpret_cast<uintptr_t>(buffer_ + used) + page - 1) & ~(page - 1);
+    const uintptr_t stop = reinterpret_cast<uintptr_t>(buffer_ + capacity_) & ~(page - 1);
+    return start < stop && ::madvise(reinterpret_cast<void*>(start), stop - start, MADV_DONTNEED) == 0;
+#else
+    return false;
+#endif
+}
+
+template<typename T, size_t Alignment>
+inline void RawMemory<T, Alignment>::Free() noexcept
+{
+    if (buffer_ != nullptr)
+    {
+        if (deleter_.free_function != nullptr)
+        {
+            deleter_(buffer_, capacity_);
+        }
+        else
+        {
+            Deallocate(buffer_, capacity_);
+        }
+    }
+    if (budget_ != nullptr)
+    {
+        budget_->Release(capacity_ * sizeof(T));
+    }
+    buffer_ = nullptr;
+    capacity_ = 0;
+    deleter_ = {};
+}
+
+template<typename T, size_t Alignment>
+inline void RawMemory<T, Alignment>::FreeAllocated(void*, T* buf, size_t capacity) noexcept
+{
+    Deallocate(buf, capacity);
+}
+
+template<typename T, size_t Alignment>
+inline T* RawMemory<T, Alignment>::Allocate(size_t n)
+{
+    if (n == 0)
+    {
+        return nullptr;
+    }
+    T* buf;
+    if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        buf = static_cast<T*>(operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    else
+    {
+        buf = static_cast<T*>(operator new(n * sizeof(T)));
+    }
+    VECTOR_PROBE3(allocate, sizeof(T), n, reinterpret_cast<uintptr_t>(buf));
+    return buf;
+}
+
+template<typename T, size_t Alignment>
+inline T* RawMemory<T, Alignment>::TryAllocate(size_t n) noexcept
+{
+    T* buf;
+    if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        buf = static_cast<T*>(operator new(n * sizeof(T), std::align_val_t(Alignment), std::nothrow));
+    }
+    else
+    {
+        buf = static_cast<T*>(operator new(n * sizeof(T), std::nothrow));
+    }
+    if (buf != nullptr)
+    {
+        VECTOR_PROBE3(allocate, sizeof(T), n, reinterpret_cast<uintptr_t>(buf));
+    }
+    return buf;
+}
+
+template<typename T, size_t Alignment>
+inline void RawMemory<T, Alignment>::Deallocate(T* buf, size_t capacity) noexcept
+{
+    VECTOR_PROBE3(deallocate, sizeof(T), capacity, reinterpret_cast<uintptr_t>(buf));
+    if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        operator delete(buf, std::align_val_t(Alignment));
+    }
+    else
+    {
+        operator delete(buf);
+    }
+}
+
+template<typename T, size_t Alignment>
+inline bool RawMemory<T, Alignment>::ChargeBudget(MemoryBudget* budget, size_t bytes) noexcept
 {
-    operator delete(buf);
+    return budget->TryCharge(bytes)
+        || (NotifyMemoryPressure(bytes, AllocStatus::kBudgetExceeded) && budget->TryCharge(bytes));
 }
 
 //--------Operators-------
 
-template<typename T>
-inline RawMemory<T>& RawMemory<T>::operator=(RawMemory&& rhs) noexcept
+template<typename T, size_t Alignment>
+inline RawMemory<T, Alignment>& RawMemory<T, Alignment>::operator=(RawMemory&& rhs) noexcept
 {
     if (&buffer_ != &rhs.buffer_)
     {
@@ -186,27 +561,27 @@ inline RawMemory<T>& RawMemory<T>::operator=(RawMemory&& rhs) noexcept
     return *this;
 }
 
-template<typename T>
-inline T* RawMemory<T>::operator+(size_t offset) noexcept
+template<typename T, size_t Alignment>
+inline T* RawMemory<T, Alignment>::operator+(size_t offset) noexcept
 {
     assert(offset <= capacity_);
     return buffer_ + offset;
 }
 
-template<typename T>
-inline const T* RawMemory<T>::operator+(size_t offset) const noexcept
+template<typename T, size_t Alignment>
+inline const T* RawMemory<T, Alignment>::operator+(size_t offset) const noexcept
 {
     return const_cast<RawMemory&>(*this) + offset;
 }
 
-template<typename T>
-inline const T& RawMemory<T>::operator[](size_t index) const noexcept
+template<typename T, size_t Alignment>
+inline const T& RawMemory<T, Alignment>::operator[](size_t index) const noexcept
 {
     return const_cast<RawMemory&>(*this)[index];
 }
 
-template<typename T>
-inline T& RawMemory<T>::operator[](size_t index) noexcept
+template<typename T, size_t Alignment>
+inline T& RawMemory<T, Alignment>::operator[](size_t index) noexcept
 {
     return buffer_[index];
 }
@@ -223,11 +598,17 @@ inline Vector<T>::Vector(size_t size) : data_(size), size_(size)
 template<typename T>
 inline Vector<T>::Vector(const Vector& other)
 {
-    RawMemory<T>  new_data(other.size_);
+    RawMemory<T>  new_data(other.size_, other.data_.Budget());
     std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, new_data.GetAddress());
     std::destroy_n(data_.GetAddress(), size_);
     data_.Swap(new_data);
     size_ = other.size_;
+    decay_ = other.decay_;
+    if (other.trace_ != nullptr)
+    {
+        trace_ = other.trace_;
+        trace_id_ = trace_->AttachCopy(other.trace_id_);
+    }
 }
 
 template<typename T>
@@ -243,6 +624,7 @@ template<typename T>
 inline Vector<T>::~Vector() noexcept
 {
     std::destroy_n(data_.GetAddress(), size_);
+    Trace(TraceOp::kDestroy);
 }
 
 //-----------Iterators--------
@@ -286,13 +668,16 @@ inline const T* Vector<T>::cend() const noexcept
 //------------Methods--------------
 
 template<typename T>
-inline void Vector<T>::Reserve(size_t new_capacity) noexcept
+inline void Vector<T>::Reserve(size_t new_capacity)
 {
+    Trace(TraceOp::kReserve, new_capacity);
     if (new_capacity <= data_.Capacity())
     {
         return;
     }
-    RawMemory<T> new_data(new_capacity);
+    const size_t old_capacity = data_.Capacity();
+    VECTOR_PROBE4(reserve, sizeof(T), old_capacity, new_capacity, size_);
+    RawMemory<T> new_data(new_capacity, data_.Budget());
     if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
     {
         std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
@@ -303,38 +688,34 @@ inline void Vector<T>::Reserve(size_t new_capacity) noexcept
     }
     std::destroy_n(data_.GetAddress(), size_);
     data_.Swap(new_data);
+    VECTOR_PROBE4(relocated, sizeof(T), old_capacity, new_capacity, size_);
 }
 
 template<typename T>
-inline void Vector<T>::Resize(size_t size) noexcept
+inline void Vector<T>::Resize(size_t size)
 {
     if (Size() > size)
     {
         std::destroy_n(data_.GetAddress() + size, Size() - size);
         size_ = size;
+        NoteRemoval();
     }
     else
     {
-        if (Capacity() > size)
-        {
-            std::destroy_n(data_.GetAddress() + size, Size() - size);
-            size_ = size;
-        }
-        else
-        {
-            Reserve(size);
-            std::uninitialized_value_construct_n(data_.GetAddress() + Size(), size - Size());
-            size_ = size;
-        }
+        Reserve(size);
+        std::uninitialized_value_construct_n(data_.GetAddress() + Size(), size - Size());
+        size_ = size;
     }
+    Trace(TraceOp::kResize, size);
 }
 
 template<typename T>
-inline void Vector<T>::PushBack(const T& value) noexcept
+inline void Vector<T>::PushBack(const T& value)
 {
     if (Size() == Capacity())
     {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+        VECTOR_PROBE4(grow, sizeof(T), size_, size_ == 0 ? 1 : size_ * 2, size_);
+        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2, data_.Budget());
         new(new_data.GetAddress() + size_) T(value);
         if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
         {
@@ -346,20 +727,23 @@ inline void Vector<T>::PushBack(const T& value) noexcept
         }
         std::destroy_n(data_.GetAddress(), size_);
         data_.Swap(new_data);
+        VECTOR_PROBE4(relocated, sizeof(T), size_, data_.Capacity(), size_);
     }
     else
     {
         new(data_.GetAddress() + size_) T(value);
     }
     ++size_;
+    Trace(TraceOp::kPushBack);
 }
 
 template<typename T>
-inline void Vector<T>::PushBack(T&& value) noexcept
+inline void Vector<T>::PushBack(T&& value)
 {
     if (Size() == Capacity())
     {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+        VECTOR_PROBE4(grow, sizeof(T), size_, size_ == 0 ? 1 : size_ * 2, size_);
+        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2, data_.Budget());
         new(new_data.GetAddress() + size_) T(std::move(value));
         if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
         {
@@ -371,12 +755,14 @@ inline void Vector<T>::PushBack(T&& value) noexcept
         }
         std::destroy_n(data_.GetAddress(), size_);
         data_.Swap(new_data);
+        VECTOR_PROBE4(relocated, sizeof(T), size_, data_.Capacity(), size_);
     }
     else
     {
         new(data_.GetAddress() + size_) T(std::move(value));
     }
     ++size_;
+    Trace(TraceOp::kPushBack);
 }
 
 template<typename T>
@@ -385,15 +771,76 @@ inline void Vector<T>::PopBack()
     assert(size_ != 0);
     std::destroy_at(data_.GetAddress() + size_ - 1);
     --size_;
+    Trace(TraceOp::kPopBack);
+    NoteRemoval();
+}
+
+template<typename T>
+inline void Vector<T>::Clear() noexcept
+{
+    std::destroy_n(data_.GetAddress(), size_);
+    size_ = 0;
+    Trace(TraceOp::kClear);
+    NoteRemoval();
+}
+
+template<typename T>
+inline void Vector<T>::ClearAndTrim() noexcept
+{
+    std::destroy_n(data_.GetAddress(), size_);
+    size_ = 0;
+    RawMemory<T> empty;
+    empty.SetBudget(data_.Budget());
+    data_.Swap(empty);
+    decay_count_ = 0;
+    Trace(TraceOp::kClearAndTrim);
+}
+
+template<typename T>
+inline void Vector<T>::ShrinkToFit()
+{
+    if (size_ < data_.Capacity())
+    {
+        ReallocateExactly(size_);
+    }
+    Trace(TraceOp::kShrinkToFit);
+}
+
+template<typename T>
+inline void Vector<T>::SetDecayPolicy(DecayPolicy policy) noexcept
+{
+    decay_ = policy;
+    decay_count_ = 0;
+}
+
+template<typename T>
+inline void Vector<T>::SetTraceRecorder(TraceRecorder* recorder) noexcept
+{
+    if (recorder == trace_)
+    {
+        return;
+    }
+    Trace(TraceOp::kDestroy);
+    trace_ = recorder;
+    if (trace_ != nullptr)
+    {
+        trace_id_ = trace_->Attach(sizeof(T));
+        if (data_.Capacity() != 0)
+        {
+            Trace(TraceOp::kReserve, data_.Capacity());
+            Trace(TraceOp::kResize, size_);
+        }
+    }
 }
 
 template<typename T>
 template<typename ...Args>
-inline T& Vector<T>::EmplaceBack(Args && ...args) noexcept
+inline T& Vector<T>::EmplaceBack(Args && ...args)
 {
     if (Size() == Capacity())
     {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+        VECTOR_PROBE4(grow, sizeof(T), size_, size_ == 0 ? 1 : size_ * 2, size_);
+        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2, data_.Budget());
         new(new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
         if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
         {
@@ -405,12 +852,14 @@ inline T& Vector<T>::EmplaceBack(Args && ...args) noexcept
         }
         std::destroy_n(data_.GetAddress(), size_);
         data_.Swap(new_data);
+        VECTOR_PROBE4(relocated, sizeof(T), size_, data_.Capacity(), size_);
     }
     else
     {
         new(data_.GetAddress() + size_) T(std::forward<Args>(args)...);
     }
     ++size_;
+    Trace(TraceOp::kPushBack);
     return data_[size_ - 1];
 }
 
@@ -420,32 +869,43 @@ inline T* Vector<T>::Emplace(const_iterator pos, Args && ...args)
 {
     iterator pos_emplace = const_cast<iterator>(pos);
     size_t dis = std::distance(begin(), pos_emplace);
-    iterator it_value = &data_[dis];
+    iterator it_value = data_.GetAddress() + dis;
     if (Size() == Capacity())
     {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
-        try
+        VECTOR_PROBE4(grow, sizeof(T), size_, size_ == 0 ? 1 : size_ * 2, size_);
+        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2, data_.Budget());
+        new(new_data.GetAddress() + dis) T(std::forward<Args>(args)...);
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        {
+            std::uninitialized_move_n(data_.GetAddress(), dis, new_data.GetAddress());
+            std::uninitialized_move_n(data_.GetAddress() + dis, size_ - dis, new_data.GetAddress() + (dis + 1));
+        }
+        else
         {
-            new(new_data.GetAddress() + dis) T(std::forward<Args>(args)...);
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+            try
             {
-                std::uninitialized_move_n(data_.GetAddress(), dis, new_data.GetAddress());
-                std::uninitialized_move_n(data_.GetAddress() + dis, size_ - dis, new_data.GetAddress() + (dis + 1));
+                std::uninitialized_copy_n(data_.GetAddress(), dis, new_data.GetAddress());
             }
-            else
+            catch (...)
+            {
+                std::destroy_at(new_data.GetAddress() + dis);
+                throw;
+            }
+            try
             {
-                std::uninitialized_copy_n(data_.GetAddress(), dis, new_data.GetAddress());
                 std::uninitialized_copy_n(data_.GetAddress() + dis, size_ - dis, new_data.GetAddress() + (dis + 1));
             }
-        }
-        catch (...)
-        {
-            new_data.~RawMemory();
+            catch (...)
+            {
+                std::destroy_n(new_data.GetAddress(), dis + 1);
+                throw;
+            }
         }
 
         std::destroy_n(data_.GetAddress(), size_);
         data_.Swap(new_data);
-        it_value = &data_[dis];
+        VECTOR_PROBE4(relocated, sizeof(T), size_, data_.Capacity(), size_);
+        it_value = data_.GetAddress() + dis;
     }
     else
     {
@@ -461,6 +921,7 @@ inline T* Vector<T>::Emplace(const_iterator pos, Args && ...args)
         }
     }
     ++size_;
+    Trace(TraceOp::kInsert, dis);
     return it_value;
 }
 
@@ -472,7 +933,11 @@ inline T* Vector<T>::Erase(const_iterator pos)
     std::destroy_at(pos_erase);
     std::move(pos_erase + 1, end(), pos_erase);
     --size_;
-    return pos_erase;
+    // Decay may reallocate, so the result is rebuilt from the index.
+    const size_t index = static_cast<size_t>(pos_erase - begin());
+    Trace(TraceOp::kErase, index);
+    NoteRemoval();
+    return begin() + index;
 }
 
 template<typename T>
@@ -492,6 +957,10 @@ inline void Vector<T>::Swap(Vector& rhs) noexcept
 {
     data_.Swap(rhs.data_);
     std::swap(size_, rhs.size_);
+    std::swap(decay_, rhs.decay_);
+    std::swap(decay_count_, rhs.decay_count_);
+    std::swap(trace_, rhs.trace_);
+    std::swap(trace_id_, rhs.trace_id_);
 }
 
 template<typename T>
@@ -506,17 +975,242 @@ inline size_t Vector<T>::Capacity() const noexcept
     return data_.Capacity();
 }
 
+template<typename T>
+inline Footprint Vector<T>::MemoryFootprint() const noexcept
+{
+    Footprint result;
+    result.used_bytes = size_ * sizeof(T);
+    result.reserved_bytes = data_.Capacity() * sizeof(T);
+    result.slack_bytes = result.reserved_bytes - result.used_bytes;
+    if constexpr (FootprintTraits<T>::has_nested)
+    {
+        for (size_t i = 0; i < size_; ++i)
+        {
+            result += FootprintTraits<T>::Nested(data_[i]);
+        }
+    }
+    return result;
+}
+
+template<typename T>
+inline T* Vector<T>::Data() noexcept
+{
+    return data_.GetAddress();
+}
+
+template<typename T>
+inline const T* Vector<T>::Data() const noexcept
+{
+    return data_.GetAddress();
+}
+
+template<typename T>
+inline ReleasedBuffer<T> Vector<T>::Release() noexcept
+{
+    ReleasedBuffer<T> result;
+    result.size = std::exchange(size_, 0);
+    result.capacity = data_.Capacity();
+    result.data = data_.Release(result.deleter);
+    Trace(TraceOp::kClearAndTrim);
+    return result;
+}
+
+template<typename T>
+inline void Vector<T>::Adopt(T* data, size_t size, size_t capacity, BufferDeleter<T> deleter) noexcept
+{
+    assert(size <= capacity);
+    std::destroy_n(data_.GetAddress(), size_);
+    data_.Adopt(data, capacity, deleter);
+    size_ = size;
+    Trace(TraceOp::kClearAndTrim);
+    Trace(TraceOp::kReserve, capacity);
+    Trace(TraceOp::kResize, size);
+}
+
+template<typename T>
+inline AllocStatus Vector<T>::TryReserve(size_t new_capacity)
+{
+    if (new_capacity <= data_.Capacity())
+    {
+        Trace(TraceOp::kReserve, new_capacity);
+        return AllocStatus::kOk;
+    }
+    const size_t old_capacity = data_.Capacity();
+    VECTOR_PROBE4(reserve, sizeof(T), old_capacity, new_capacity, size_);
+    RawMemory<T> new_data;
+    const AllocStatus status = RawMemory<T>::TryCreate(new_capacity, data_.Budget(), new_data);
+    if (status != AllocStatus::kOk)
+    {
+        return status;
+    }
+    RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+    std::destroy_n(data_.GetAddress(), size_);
+    data_.Swap(new_data);
+    VECTOR_PROBE4(relocated, sizeof(T), old_capacity, new_capacity, size_);
+    Trace(TraceOp::kReserve, new_capacity);
+    return AllocStatus::kOk;
+}
+
+template<typename T>
+inline AllocStatus Vector<T>::TryPushBack(const T& value)
+{
+    return TryEmplaceBack(value);
+}
+
+template<typename T>
+inline AllocStatus Vector<T>::TryPushBack(T&& value)
+{
+    return TryEmplaceBack(std::move(value));
+}
+
+template<typename T>
+template<typename ...Args>
+inline AllocStatus Vector<T>::TryEmplaceBack(Args && ...args)
+{
+    if (Size() == Capacity())
+    {
+        VECTOR_PROBE4(grow, sizeof(T), size_, size_ == 0 ? 1 : size_ * 2, size_);
+        RawMemory<T> new_data;
+        const AllocStatus status = RawMemory<T>::TryCreate(size_ == 0 ? 1 : size_ * 2, data_.Budget(), new_data);
+        if (status != AllocStatus::kOk)
+        {
+            return status;
+        }
+        new(new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
+        try
+        {
+            RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+        }
+        catch (...)
+        {
+            std::destroy_at(new_data.GetAddress() + size_);
+            throw;
+        }
+        std::destroy_n(data_.GetAddress(), size_);
+        data_.Swap(new_data);
+        VECTOR_PROBE4(relocated, sizeof(T), size_, data_.Capacity(), size_);
+    }
+    else
+    {
+        new(data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+    }
+    ++size_;
+    Trace(TraceOp::kPushBack);
+    return AllocStatus::kOk;
+}
+
+template<typename T>
+inline void Vector<T>::SetBudget(MemoryBudget* budget) noexcept
+{
+    data_.SetBudget(budget);
+}
+
+template<typename T>
+inline MemoryBudget* Vector<T>::Budget() const noexcept
+{
+    return data_.Budget();
+}
+
+template<typename T>
+template<typename Fill>
+inline size_t Vector<T>::AppendInPlace(size_t max_count, Fill fill)
+{
+    if (Capacity() - size_ < max_count)
+    {
+        Reserve(std::max(size_ + max_count, size_ * 2));
+    }
+    const size_t produced = fill(data_.GetAddress() + size_, max_count);
+    assert(produced <= max_count);
+    size_ += produced;
+    Trace(TraceOp::kResize, size_);
+    return produced;
+}
+
+template<typename T>
+inline void Vector<T>::RelocateN(T* from, size_t count, T* to)
+{
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+    {
+        std::uninitialized_move_n(from, count, to);
+    }
+    else
+    {
+        std::uninitialized_copy_n(from, count, to);
+    }
+}
+
+template<typename T>
+inline void Vector<T>::NoteRemoval() noexcept
+{
+    if (decay_.window == 0)
+    {
+        return;
+    }
+    if (size_ * 100 >= data_.Capacity() * decay_.usage_percent)
+    {
+        decay_count_ = 0;
+    }
+    else if (++decay_count_ >= decay_.window)
+    {
+        decay_count_ = 0;
+        Decay();
+    }
+}
+
+template<typename T>
+inline void Vector<T>::Decay() noexcept
+{
+    if (data_.DiscardUnused(size_))
+    {
+        return;
+    }
+    try
+    {
+        ReallocateExactly(size_ * 2 < data_.Capacity() ? size_ * 2 : size_);
+    }
+    catch (...)
+    {
+        // Decay is best effort: keep the current buffer if a copy fails.
+    }
+}
+
+template<typename T>
+inline bool Vector<T>::ReallocateExactly(size_t capacity)
+{
+    assert(size_ <= capacity);
+    RawMemory<T> new_data;
+    if (RawMemory<T>::TryCreate(capacity, data_.Budget(), new_data) != AllocStatus::kOk)
+    {
+        return false;
+    }
+    RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+    std::destroy_n(data_.GetAddress(), size_);
+    data_.Swap(new_data);
+    return true;
+}
+
+template<typename T>
+inline void Vector<T>::Trace(TraceOp op, uint64_t arg) const noexcept
+{
+    if (trace_ != nullptr)
+    {
+        trace_->Record(op, trace_id_, arg);
+    }
+}
+
 //------------Operators-------------
 
 template<typename T>
-inline Vector<T>& Vector<T>::operator=(const Vector& rhs) noexcept
+inline Vector<T>& Vector<T>::operator=(const Vector& rhs)
 {
     if (this != &rhs)
     {
         if (rhs.size_ > data_.Capacity())
         {
-            Vector rhs_copy(rhs);
-            Swap(rhs_copy);
+            RawMemory<T> new_data(rhs.size_, data_.Budget());
+            std::uninitialized_copy_n(rhs.data_.GetAddress(), rhs.size_, new_data.GetAddress());
+            std::destroy_n(data_.GetAddress(), size_);
+            data_.Swap(new_data);
         }
         else
         {
@@ -535,6 +1229,7 @@ inline Vector<T>& Vector<T>::operator=(const Vector& rhs) noexcept
         }
     }
     size_ = rhs.size_;
+    Trace(TraceOp::kAssign, size_);
     return *this;
 }
 
@@ -557,7 +1252,35 @@ inline const T& Vector<T>::operator[](size_t index) const noexcept
 template<typename T>
 inline T& Vector<T>::operator[](size_t index) noexcept
 {
+#ifdef VECTOR_TRACE_INDEXING
+    Trace(TraceOp::kRead, index);
+#endif
     return data_[index];
 }
 
+#ifdef __cpp_lib_span
+template<typename T>
+inline Vector<T>::operator std::span<T>() noexcept
+{
+    return std::span<T>(data_.GetAddress(), size_);
+}
+
+template<typename T>
+inline Vector<T>::operator std::span<const T>() const noexcept
+{
+    return std::span<const T>(data_.GetAddress(), size_);
+}
+#endif
+
+//------------Footprint-------------
 
+template <typename T>
+struct FootprintTraits<Vector<T>>
+{
+    static constexpr bool has_nested = true;
+
+    static Footprint Nested(const Vector<T>& value) noexcept
+    {
+        return value.MemoryFootprint();
+    }
+};
@@ -0,0 +1,312 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+#include "vector.h"
+
+// Element-wise arithmetic on numeric Vectors. `a + b * 2.0` builds a small
+// tree of expression nodes instead of temporaries; Evaluate() or Assign()
+// then runs a single loop over the destination. Operand sizes are checked
+// when the node is built.
+
+template <typename T>
+class VectorOperand
+{
+public:
+    using value_type = T;
+
+    explicit VectorOperand(const Vector<T>& vector) noexcept;
+
+    size_t Size() const noexcept;
+    T operator[](size_t index) const noexcept;
+
+private:
+    const T* data_;
+    size_t size_;
+};
+
+template <typename T>
+class ScalarOperand
+{
+public:
+    using value_type = T;
+
+    explicit ScalarOperand(T value) noexcept;
+
+    T operator[](size_t) const noexcept;
+
+private:
+    T value_;
+};
+
+template <typename Left, typename Right, typename Op>
+class BinaryExpr;
+
+template <typename E>
+struct IsVectorExpr : std::false_type {};
+
+template <typename T>
+struct IsVectorExpr<Vector<T>> : std::is_arithmetic<T> {};
+
+template <typename Left, typename Right, typename Op>
+struct IsVectorExpr<BinaryExpr<Left, Right, Op>> : std::true_type {};
+
+template <typename E>
+inline constexpr bool kIsVectorExpr = IsVectorExpr<std::decay_t<E>>::value;
+
+// How an expression or a scalar is stored inside a node: Vectors by pointer,
+// nodes and scalars by value.
+template <typename E, typename Scalar>
+struct OperandOf
+{
+    using type = ScalarOperand<Scalar>;
+};
+
+template <typename T, typename Scalar>
+struct OperandOf<Vector<T>, Scalar>
+{
+    using type = VectorOperand<T>;
+};
+
+template <typename Left, typename Right, typename Op, typename Scalar>
+struct OperandOf<BinaryExpr<Left, Right, Op>, Scalar>
+{
+    using type = BinaryExpr<Left, Right, Op>;
+};
+
+template <typename Left, typename Right, typename Op>
+class BinaryExpr
+{
+public:
+    using value_type = std::common_type_t<typename Left::value_type, typename Right::value_type>;
+
+    BinaryExpr(Left left, Right right, size_t size) noexcept;
+
+    size_t Size() const noexcept;
+    value_type operator[](size_t index) const noexcept;
+
+private:
+    Left left_;
+    Right right_;
+    size_t size_;
+};
+
+//------------Operands--------------
+
+template<typename T>
+inline VectorOperand<T>::VectorOperand(const Vector<T>& vector) noexcept
+    : data_(vector.begin())
+    , size_(vector.Size())
+{}
+
+template<typename T>
+inline size_t VectorOperand<T>::Size() const noexcept
+{
+    return size_;
+}
+
+template<typename T>
+inline T VectorOperand<T>::operator[](size_t index) const noexcept
+{
+    return data_[index];
+}
+
+template<typename T>
+inline ScalarOperand<T>::ScalarOperand(T value) noexcept
+    : value_(value)
+{}
+
+template<typename T>
+inline T ScalarOperand<T>::operator[](size_t) const noexcept
+{
+    return value_;
+}
+
+template<typename Left, typename Right, typename Op>
+inline BinaryExpr<Left, Right, Op>::BinaryExpr(Left left, Right right, size_t size) noexcept
+    : left_(left)
+    , right_(right)
+    , size_(size)
+{}
+
+template<typename Left, typename Right, typename Op>
+inline size_t BinaryExpr<Left, Right, Op>::Size() const noexcept
+{
+    return size_;
+}
+
+template<typename Left, typename Right, typename Op>
+inline typename BinaryExpr<Left, Right, Op>::value_type BinaryExpr<Left, Right, Op>::operator[](size_t index) const noexcept
+{
+    return Op{}(left_[index], right_[index]);
+}
+
+//------------Building nodes--------------
+
+namespace vector_expr_detail
+{
+    template <typename E>
+    struct ValueOf
+    {
+        using type = std::decay_t<E>;
+    };
+
+    template <typename T>
+    struct ValueOf<Vector<T>>
+    {
+        using type = T;
+    };
+
+    template <typename Left, typename Right, typename Op>
+    struct ValueOf<BinaryExpr<Left, Right, Op>>
+    {
+        using type = typename BinaryExpr<Left, Right, Op>::value_type;
+    };
+
+    template <typename E>
+    using ValueOfT = typename ValueOf<std::decay_t<E>>::type;
+
+    template <typename E>
+    size_t SizeOf(const E& operand) noexcept
+    {
+        if constexpr (kIsVectorExpr<E>)
+        {
+            return operand.Size();
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    template <typename E, typename Scalar>
+    typename OperandOf<std::decay_t<E>, Scalar>::type MakeOperand(const E& operand) noexcept
+    {
+        using Operand = typename OperandOf<std::decay_t<E>, Scalar>::type;
+        if constexpr (kIsVectorExpr<E>)
+        {
+            return Operand(operand);
+        }
+        else
+        {
+            return Operand(static_cast<Scalar>(operand));
+        }
+    }
+
+    template <typename L, typename R>
+    inline constexpr bool kIsOperandPair = (kIsVectorExpr<L> && (kIsVectorExpr<R> || std::is_arithmetic_v<std::decay_t<R>>))
+        || (std::is_arithmetic_v<std::decay_t<L>> && kIsVectorExpr<R>);
+
+    template <typename Op, typename L, typename R>
+    auto MakeBinary(const L& lhs, const R& rhs)
+    {
+        using Scalar = std::common_type_t<ValueOfT<L>, ValueOfT<R>>;
+        using LeftOperand = typename OperandOf<std::decay_t<L>, Scalar>::type;
+        using RightOperand = typename OperandOf<std::decay_t<R>, Scalar>::type;
+        size_t size = 0;
+        if constexpr (kIsVectorExpr<L> && kIsVectorExpr<R>)
+        {
+            if (lhs.Size() != rhs.Size())
+            {
+                throw std::invalid_argument("Vector expression operands differ in size");
+            }
+            size = lhs.Size();
+        }
+        else
+        {
+            size = std::max(SizeOf(lhs), SizeOf(rhs));
+        }
+        return BinaryExpr<LeftOperand, RightOperand, Op>(
+            MakeOperand<L, Scalar>(lhs), MakeOperand<R, Scalar>(rhs), size);
+    }
+}
+
+template <typename L, typename R, std::enable_if_t<vector_expr_detail::kIsOperandPair<L, R>, int> = 0>
+auto operator+(const L& lhs, const R& rhs)
+{
+    return vector_expr_detail::MakeBinary<std::plus<>>(lhs, rhs);
+}
+
+template <typename L, typename R, std::enable_if_t<vector_expr_detail::kIsOperandPair<L, R>, int> = 0>
+auto operator-(const L& lhs, const R& rhs)
+{
+    return vector_expr_detail::MakeBinary<std::minus<>>(lhs, rhs);
+}
+
+template <typename L, typename R, std::enable_if_t<vector_expr_detail::kIsOperandPair<L, R>, int> = 0>
+auto operator*(const L& lhs, const R& rhs)
+{
+    return vector_expr_detail::MakeBinary<std::multiplies<>>(lhs, rhs);
+}
+
+template <typename L, typename R, std::enable_if_t<vector_expr_detail::kIsOperandPair<L, R>, int> = 0>
+auto operator/(const L& lhs, const R& rhs)
+{
+    return vector_expr_detail::MakeBinary<std::divides<>>(lhs, rhs);
+}
+
+//------------Evaluation--------------
+
+// Writes the expression into dst in one pass. dst may appear in the
+// expression itself because element i only reads index i.
+template <typename T, typename E, std::enable_if_t<kIsVectorExpr<E>, int> = 0>
+void Assign(Vector<T>& dst, const E& expr)
+{
+    const size_t size = expr.Size();
+    if (dst.Size() != size)
+    {
+        Vector<T> resized(size);
+        dst.Swap(resized);
+    }
+    T* out = dst.begin();
+    for (size_t i = 0; i < size; ++i)
+    {
+        out[i] = static_cast<T>(expr[i]);
+    }
+}
+
+template <typename E, std::enable_if_t<kIsVectorExpr<E>, int> = 0>
+auto Evaluate(const E& expr)
+{
+    Vector<vector_expr_detail::ValueOfT<E>> result;
+    Assign(result, expr);
+    return result;
+}
+
+template <typename E, std::enable_if_t<kIsVectorExpr<E>, int> = 0>
+auto Sum(const E& expr)
+{
+    vector_expr_detail::ValueOfT<E> result{};
+    for (size_t i = 0; i < expr.Size(); ++i)
+    {
+        result += expr[i];
+    }
+    return result;
+}
+
+template <typename E, std::enable_if_t<kIsVectorExpr<E>, int> = 0>
+auto Min(const E& expr)
+{
+    assert(expr.Size() != 0);
+    vector_expr_detail::ValueOfT<E> result = expr[0];
+    for (size_t i = 1; i < expr.Size(); ++i)
+    {
+        result = std::min(result, static_cast<decltype(result)>(expr[i]));
+    }
+    return result;
+}
+
+template <typename E, std::enable_if_t<kIsVectorExpr<E>, int> = 0>
+auto Max(const E& expr)
+{
+    assert(expr.Size() != 0);
+    vector_expr_detail::ValueOfT<E> result = expr[0];
+    for (size_t i = 1; i < expr.Size(); ++i)
+    {
+        result = std::max(result, static_cast<decltype(result)>(expr[i]));
+    }
+    return result;
+}
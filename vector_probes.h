@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+
+// Static tracepoints on Vector's allocation and reallocation paths, compiled in
+// with -DVECTOR_USDT. Each one is a single nop plus an ELF note, so nothing
+// happens until a tracer (bpftrace, perf, systemtap) attaches; without the
+// flag they expand to nothing. Provider "vector", arguments all 64-bit:
+//   allocate(element_size, capacity, address)
+//   deallocate(element_size, capacity, address)
+//   reserve(element_size, old_capacity, new_capacity, relocated)    Reserve
+//   grow(element_size, old_capacity, new_capacity, relocated)       a full PushBack/EmplaceBack/Emplace
+//   relocated(element_size, old_capacity, new_capacity, relocated)  end of either of the two above
+// See probes/*.bt for ready-made scripts.
+
+#if defined(VECTOR_USDT) && __has_include(<sys/sdt.h>)
+
+#include <sys/sdt.h>
+#define VECTOR_PROBE3(name, a, b, c) \
+    DTRACE_PROBE3(vector, name, static_cast<uint64_t>(a), static_cast<uint64_t>(b), static_cast<uint64_t>(c))
+#define VECTOR_PROBE4(name, a, b, c, d) \
+    DTRACE_PROBE4(vector, name, static_cast<uint64_t>(a), static_cast<uint64_t>(b), static_cast<uint64_t>(c), static_cast<uint64_t>(d))
+
+#elif defined(VECTOR_USDT) && defined(__x86_64__) && defined(__GNUC__)
+
+// The same note layout <sys/sdt.h> emits, for hosts without systemtap headers.
+#define VECTOR_SDT_PROBE(name, args, ...)                                         \
+    __asm__ __volatile__(                                                       \
+        "990: nop\n"                                                            \
+        ".pushsection .note.stapsdt,\"?\",\"note\"\n"                           \
+        ".balign 4\n"                                                           \
+        ".4byte 992f-991f, 994f-993f, 3\n"                                      \
+        "991: .asciz \"stapsdt\"\n"                                             \
+        "992: .balign 4\n"                                                      \
+        "993: .8byte 990b\n"                                                    \
+        ".8byte _.stapsdt.base\n"                                               \
+        ".8byte 0\n"                                                            \
+        ".asciz \"vector\"\n"                                                   \
+        ".asciz \"" #name "\"\n"                                                \
+        ".asciz \"" args "\"\n"                                                 \
+        "994: .balign 4\n"                                                      \
+        ".popsection\n"                                                         \
+        ".ifndef _.stapsdt.base\n"                                              \
+        ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+        ".weak _.stapsdt.base\n"                                                \
+        ".hidden _.stapsdt.base\n"                                              \
+        "_.stapsdt.base: .space 1\n"                                            \
+        ".size _.stapsdt.base, 1\n"                                             \
+        ".popsection\n"                                                         \
+        ".endif\n"                                                              \
+        :: __VA_ARGS__)
+#define VECTOR_PROBE3(name, a, b, c)                                            \
+    VECTOR_SDT_PROBE(name, "8@%0 8@%1 8@%2",                                    \
+        "nor"(static_cast<uint64_t>(a)), "nor"(static_cast<uint64_t>(b)), "nor"(static_cast<uint64_t>(c)))
+#define VECTOR_PROBE4(name, a, b, c, d)                                         \
+    VECTOR_SDT_PROBE(name, "8@%0 8@%1 8@%2 8@%3",                               \
+        "nor"(static_cast<uint64_t>(a)), "nor"(static_cast<uint64_t>(b)),       \
+        "nor"(static_cast<uint64_t>(c)), "nor"(static_cast<uint64_t>(d)))
+
+#else
+
+// Unevaluated, but still type-checked and counted as uses of the arguments.
+#define VECTOR_PROBE3(name, a, b, c) ((void)sizeof(a), (void)sizeof(b), (void)sizeof(c))
+#define VECTOR_PROBE4(name, a, b, c, d) ((void)sizeof(a), (void)sizeof(b), (void)sizeof(c), (void)sizeof(d))
+
+#endif
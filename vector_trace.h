@@ -0,0 +1,213 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// Operations a traced Vector logs. kCreate carries the element size, kCopy the
+// id of the source vector, kAssign the new size, kRead the index and the rest
+// the size, capacity or position their Vector call was given.
+enum class TraceOp : uint8_t
+{
+    kCreate,
+    kCopy,
+    kAssign,
+    kDestroy,
+    kReserve,
+    kResize,
+    kPushBack,
+    kPopBack,
+    kInsert,
+    kErase,
+    kClear,
+    kClearAndTrim,
+    kShrinkToFit,
+    kRead,
+};
+
+inline constexpr size_t kTraceOpCount = 14;
+
+struct TraceEvent
+{
+    TraceOp op = TraceOp::kCreate;
+    uint32_t vector = 0;
+    uint64_t arg = 0;
+};
+
+inline constexpr bool TraceOpHasArg(TraceOp op) noexcept
+{
+    switch (op)
+    {
+    case TraceOp::kDestroy:
+    case TraceOp::kPushBack:
+    case TraceOp::kPopBack:
+    case TraceOp::kClear:
+    case TraceOp::kClearAndTrim:
+    case TraceOp::kShrinkToFit:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Collects the operations of every Vector attached to it as a compact byte
+// stream: one opcode byte, then the vector id and the argument as LEB128
+// varints, so a typical event takes 2-4 bytes. Safe to share between threads.
+// Recording never throws; events that do not fit in memory are counted in
+// Dropped() instead.
+class TraceRecorder
+{
+public:
+    TraceRecorder() = default;
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // Hands out the id of a new traced vector and records its creation.
+    uint32_t Attach(size_t element_size) noexcept;
+    uint32_t AttachCopy(uint32_t source) noexcept;
+
+    void Record(TraceOp op, uint32_t vector, uint64_t arg = 0) noexcept;
+
+    size_t EventCount() const;
+    size_t Dropped() const;
+    std::vector<unsigned char> Bytes() const;
+
+    bool Save(const char* path) const;
+    void Clear();
+
+private:
+    static void Append(std::vector<unsigned char>& out, uint64_t value);
+
+    mutable std::mutex mutex_;
+    std::vector<unsigned char> bytes_;
+    uint32_t next_id_ = 0;
+    size_t events_ = 0;
+    size_t dropped_ = 0;
+};
+
+// Reads the event at pos and advances pos; false at the end of the stream or
+// on a malformed event.
+inline bool DecodeTraceEvent(const unsigned char*& pos, const unsigned char* end, TraceEvent& event) noexcept
+{
+    const auto read = [&](uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; pos != end && shift < 64; shift += 7)
+        {
+            const unsigned char byte = *pos++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    if (pos == end || *pos >= kTraceOpCount)
+    {
+        return false;
+    }
+    event.op = static_cast<TraceOp>(*pos++);
+    uint64_t vector = 0;
+    if (!read(vector) || vector > UINT32_MAX)
+    {
+        return false;
+    }
+    event.vector = static_cast<uint32_t>(vector);
+    event.arg = 0;
+    return !TraceOpHasArg(event.op) || read(event.arg);
+}
+
+//------------TraceRecorder----------------
+
+inline uint32_t TraceRecorder::Attach(size_t element_size) noexcept
+{
+    uint32_t id;
+    {
+        std::lock_guard lock(mutex_);
+        id = next_id_++;
+    }
+    Record(TraceOp::kCreate, id, element_size);
+    return id;
+}
+
+inline uint32_t TraceRecorder::AttachCopy(uint32_t source) noexcept
+{
+    uint32_t id;
+    {
+        std::lock_guard lock(mutex_);
+        id = next_id_++;
+    }
+    Record(TraceOp::kCopy, id, source);
+    return id;
+}
+
+inline void TraceRecorder::Record(TraceOp op, uint32_t vector, uint64_t arg) noexcept
+{
+    std::lock_guard lock(mutex_);
+    const size_t old_size = bytes_.size();
+    try
+    {
+        bytes_.push_back(static_cast<unsigned char>(op));
+        Append(bytes_, vector);
+        if (TraceOpHasArg(op))
+        {
+            Append(bytes_, arg);
+        }
+        ++events_;
+    }
+    catch (...)
+    {
+        bytes_.resize(old_size);
+        ++dropped_;
+    }
+}
+
+inline size_t TraceRecorder::EventCount() const
+{
+    std::lock_guard lock(mutex_);
+    return events_;
+}
+
+inline size_t TraceRecorder::Dropped() const
+{
+    std::lock_guard lock(mutex_);
+    return dropped_;
+}
+
+inline std::vector<unsigned char> TraceRecorder::Bytes() const
+{
+    std::lock_guard lock(mutex_);
+    return bytes_;
+}
+
+inline bool TraceRecorder::Save(const char* path) const
+{
+    std::lock_guard lock(mutex_);
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    const bool written = std::fwrite(bytes_.data(), 1, bytes_.size(), file) == bytes_.size();
+    return std::fclose(file) == 0 && written;
+}
+
+inline void TraceRecorder::Clear()
+{
+    std::lock_guard lock(mutex_);
+    bytes_.clear();
+    events_ = 0;
+    dropped_ = 0;
+}
+
+inline void TraceRecorder::Append(std::vector<unsigned char>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
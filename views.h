@@ -0,0 +1,743 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+// Lazy adaptors over Vector ranges. A view is a cheap value describing how to
+// produce elements; nothing is computed until ForEach() or Collect() walks it
+// with a cursor, so a chain such as Filter -> Map -> Take runs as one loop.
+//
+// Every view provides:
+//   value_type, kKnownSize, Size() (meaningful when kKnownSize),
+//   MakeCursor() returning an object with Valid(), Get() and Advance().
+
+template <typename T>
+class VectorRange;
+
+template <typename Source, typename F>
+class MapView;
+
+template <typename Source, typename Pred>
+class FilterView;
+
+template <typename Source>
+class TakeView;
+
+template <typename Source>
+class StrideView;
+
+template <typename Left, typename Right>
+class ZipView;
+
+template <typename T>
+class ChunkView;
+
+template <typename Derived>
+class ViewBase
+{
+public:
+    template <typename F>
+    MapView<Derived, F> Map(F func) const;
+
+    template <typename Pred>
+    FilterView<Derived, Pred> Filter(Pred pred) const;
+
+    TakeView<Derived> Take(size_t count) const;
+
+    StrideView<Derived> Stride(size_t step) const;
+
+    template <typename Other>
+    ZipView<Derived, Other> Zip(const Other& other) const;
+
+    template <typename F>
+    void ForEach(F&& func) const;
+
+    // Sizes the result exactly when the length is known up front. Result
+    // defaults to the view's value_type.
+    template <typename Result = void>
+    auto Collect() const;
+
+private:
+    const Derived& Self() const noexcept;
+};
+
+//----------------------------VectorRange------------------------------------------------
+
+template <typename T>
+class VectorRange : public ViewBase<VectorRange<T>>
+{
+public:
+    using value_type = T;
+    static constexpr bool kKnownSize = true;
+
+    class Cursor
+    {
+    public:
+        Cursor(const T* current, const T* last) noexcept;
+
+        bool Valid() const noexcept;
+        const T& Get() const noexcept;
+        void Advance() noexcept;
+
+    private:
+        const T* current_;
+        const T* last_;
+    };
+
+    VectorRange(const T* first, const T* last) noexcept;
+
+    const T* begin() const noexcept;
+    const T* end() const noexcept;
+
+    size_t Size() const noexcept;
+    Cursor MakeCursor() const noexcept;
+
+    ChunkView<T> Chunk(size_t chunk_size) const;
+
+    const T& operator[](size_t index) const noexcept;
+
+private:
+    const T* first_;
+    const T* last_;
+};
+
+template <typename T>
+VectorRange<T> AsView(const Vector<T>& vector) noexcept
+{
+    return VectorRange<T>(vector.begin(), vector.end());
+}
+
+template<typename T>
+inline VectorRange<T>::Cursor::Cursor(const T* current, const T* last) noexcept
+    : current_(current)
+    , last_(last)
+{}
+
+template<typename T>
+inline bool VectorRange<T>::Cursor::Valid() const noexcept
+{
+    return current_ != last_;
+}
+
+template<typename T>
+inline const T& VectorRange<T>::Cursor::Get() const noexcept
+{
+    return *current_;
+}
+
+template<typename T>
+inline void VectorRange<T>::Cursor::Advance() noexcept
+{
+    ++current_;
+}
+
+template<typename T>
+inline VectorRange<T>::VectorRange(const T* first, const T* last) noexcept
+    : first_(first)
+    , last_(last)
+{}
+
+template<typename T>
+inline const T* VectorRange<T>::begin() const noexcept
+{
+    return first_;
+}
+
+template<typename T>
+inline const T* VectorRange<T>::end() const noexcept
+{
+    return last_;
+}
+
+template<typename T>
+inline size_t VectorRange<T>::Size() const noexcept
+{
+    return static_cast<size_t>(last_ - first_);
+}
+
+template<typename T>
+inline typename VectorRange<T>::Cursor VectorRange<T>::MakeCursor() const noexcept
+{
+    return Cursor(first_, last_);
+}
+
+template<typename T>
+inline ChunkView<T> VectorRange<T>::Chunk(size_t chunk_size) const
+{
+    return ChunkView<T>(*this, chunk_size);
+}
+
+template<typename T>
+inline const T& VectorRange<T>::operator[](size_t index) const noexcept
+{
+    assert(index < Size());
+    return first_[index];
+}
+
+//----------------------------MapView------------------------------------------------
+
+template <typename Source, typename F>
+class MapView : public ViewBase<MapView<Source, F>>
+{
+    using SourceCursor = decltype(std::declval<const Source&>().MakeCursor());
+
+public:
+    using value_type = std::decay_t<std::invoke_result_t<const F&, decltype(std::declval<const SourceCursor&>().Get())>>;
+    static constexpr bool kKnownSize = Source::kKnownSize;
+
+    class Cursor
+    {
+    public:
+        Cursor(SourceCursor source, const F* func);
+
+        bool Valid() const;
+        value_type Get() const;
+        void Advance();
+
+    private:
+        SourceCursor source_;
+        const F* func_;
+    };
+
+    MapView(Source source, F func);
+
+    size_t Size() const;
+    Cursor MakeCursor() const;
+
+private:
+    Source source_;
+    F func_;
+};
+
+template<typename Source, typename F>
+inline MapView<Source, F>::Cursor::Cursor(SourceCursor source, const F* func)
+    : source_(std::move(source))
+    , func_(func)
+{}
+
+template<typename Source, typename F>
+inline bool MapView<Source, F>::Cursor::Valid() const
+{
+    return source_.Valid();
+}
+
+template<typename Source, typename F>
+inline typename MapView<Source, F>::value_type MapView<Source, F>::Cursor::Get() const
+{
+    return (*func_)(source_.Get());
+}
+
+template<typename Source, typename F>
+inline void MapView<Source, F>::Cursor::Advance()
+{
+    source_.Advance();
+}
+
+template<typename Source, typename F>
+inline MapView<Source, F>::MapView(Source source, F func)
+    : source_(std::move(source))
+    , func_(std::move(func))
+{}
+
+template<typename Source, typename F>
+inline size_t MapView<Source, F>::Size() const
+{
+    return source_.Size();
+}
+
+template<typename Source, typename F>
+inline typename MapView<Source, F>::Cursor MapView<Source, F>::MakeCursor() const
+{
+    return Cursor(source_.MakeCursor(), &func_);
+}
+
+//----------------------------FilterView------------------------------------------------
+
+template <typename Source, typename Pred>
+class FilterView : public ViewBase<FilterView<Source, Pred>>
+{
+    using SourceCursor = decltype(std::declval<const Source&>().MakeCursor());
+
+public:
+    using value_type = typename Source::value_type;
+    static constexpr bool kKnownSize = false;
+
+    class Cursor
+    {
+    public:
+        Cursor(SourceCursor source, const Pred* pred);
+
+        bool Valid() const;
+        decltype(auto) Get() const;
+        void Advance();
+
+    private:
+        void SkipRejected();
+
+        SourceCursor source_;
+        const Pred* pred_;
+    };
+
+    FilterView(Source source, Pred pred);
+
+    size_t Size() const;
+    Cursor MakeCursor() const;
+
+private:
+    Source source_;
+    Pred pred_;
+};
+
+template<typename Source, typename Pred>
+inline FilterView<Source, Pred>::Cursor::Cursor(SourceCursor source, const Pred* pred)
+    : source_(std::move(source))
+    , pred_(pred)
+{
+    SkipRejected();
+}
+
+template<typename Source, typename Pred>
+inline bool FilterView<Source, Pred>::Cursor::Valid() const
+{
+    return source_.Valid();
+}
+
+template<typename Source, typename Pred>
+inline decltype(auto) FilterView<Source, Pred>::Cursor::Get() const
+{
+    return source_.Get();
+}
+
+template<typename Source, typename Pred>
+inline void FilterView<Source, Pred>::Cursor::Advance()
+{
+    source_.Advance();
+    SkipRejected();
+}
+
+template<typename Source, typename Pred>
+inline void FilterView<Source, Pred>::Cursor::SkipRejected()
+{
+    while (source_.Valid() && !(*pred_)(source_.Get()))
+    {
+        source_.Advance();
+    }
+}
+
+template<typename Source, typename Pred>
+inline FilterView<Source, Pred>::FilterView(Source source, Pred pred)
+    : source_(std::move(source))
+    , pred_(std::move(pred))
+{}
+
+template<typename Source, typename Pred>
+inline size_t FilterView<Source, Pred>::Size() const
+{
+    size_t count = 0;
+    for (auto cursor = MakeCursor(); cursor.Valid(); cursor.Advance())
+    {
+        ++count;
+    }
+    return count;
+}
+
+template<typename Source, typename Pred>
+inline typename FilterView<Source, Pred>::Cursor FilterView<Source, Pred>::MakeCursor() const
+{
+    return Cursor(source_.MakeCursor(), &pred_);
+}
+
+//----------------------------TakeView------------------------------------------------
+
+template <typename Source>
+class TakeView : public ViewBase<TakeView<Source>>
+{
+    using SourceCursor = decltype(std::declval<const Source&>().MakeCursor());
+
+public:
+    using value_type = typename Source::value_type;
+    static constexpr bool kKnownSize = Source::kKnownSize;
+
+    class Cursor
+    {
+    public:
+        Cursor(SourceCursor source, size_t remaining);
+
+        bool Valid() const;
+        decltype(auto) Get() const;
+        void Advance();
+
+    private:
+        SourceCursor source_;
+        size_t remaining_;
+    };
+
+    TakeView(Source source, size_t count);
+
+    size_t Size() const;
+    Cursor MakeCursor() const;
+
+private:
+    Source source_;
+    size_t count_;
+};
+
+template<typename Source>
+inline TakeView<Source>::Cursor::Cursor(SourceCursor source, size_t remaining)
+    : source_(std::move(source))
+    , remaining_(remaining)
+{}
+
+template<typename Source>
+inline bool TakeView<Source>::Cursor::Valid() const
+{
+    return remaining_ != 0 && source_.Valid();
+}
+
+template<typename Source>
+inline decltype(auto) TakeView<Source>::Cursor::Get() const
+{
+    return source_.Get();
+}
+
+template<typename Source>
+inline void TakeView<Source>::Cursor::Advance()
+{
+    --remaining_;
+    // Do not pull past the last taken element: a filter would scan ahead for nothing.
+    if (remaining_ != 0)
+    {
+        source_.Advance();
+    }
+}
+
+template<typename Source>
+inline TakeView<Source>::TakeView(Source source, size_t count)
+    : source_(std::move(source))
+    , count_(count)
+{}
+
+template<typename Source>
+inline size_t TakeView<Source>::Size() const
+{
+    return std::min(count_, source_.Size());
+}
+
+template<typename Source>
+inline typename TakeView<Source>::Cursor TakeView<Source>::MakeCursor() const
+{
+    return Cursor(source_.MakeCursor(), count_);
+}
+
+//----------------------------StrideView------------------------------------------------
+
+template <typename Source>
+class StrideView : public ViewBase<StrideView<Source>>
+{
+    using SourceCursor = decltype(std::declval<const Source&>().MakeCursor());
+
+public:
+    using value_type = typename Source::value_type;
+    static constexpr bool kKnownSize = Source::kKnownSize;
+
+    class Cursor
+    {
+    public:
+        Cursor(SourceCursor source, size_t step);
+
+        bool Valid() const;
+        decltype(auto) Get() const;
+        void Advance();
+
+    private:
+        SourceCursor source_;
+        size_t step_;
+    };
+
+    StrideView(Source source, size_t step);
+
+    size_t Size() const;
+    Cursor MakeCursor() const;
+
+private:
+    Source source_;
+    size_t step_;
+};
+
+template<typename Source>
+inline StrideView<Source>::Cursor::Cursor(SourceCursor source, size_t step)
+    : source_(std::move(source))
+    , step_(step)
+{}
+
+template<typename Source>
+inline bool StrideView<Source>::Cursor::Valid() const
+{
+    return source_.Valid();
+}
+
+template<typename Source>
+inline decltype(auto) StrideView<Source>::Cursor::Get() const
+{
+    return source_.Get();
+}
+
+template<typename Source>
+inline void StrideView<Source>::Cursor::Advance()
+{
+    for (size_t i = 0; i < step_ && source_.Valid(); ++i)
+    {
+        source_.Advance();
+    }
+}
+
+template<typename Source>
+inline StrideView<Source>::StrideView(Source source, size_t step)
+    : source_(std::move(source))
+    , step_(step)
+{
+    assert(step_ != 0);
+}
+
+template<typename Source>
+inline size_t StrideView<Source>::Size() const
+{
+    return (source_.Size() + step_ - 1) / step_;
+}
+
+template<typename Source>
+inline typename StrideView<Source>::Cursor StrideView<Source>::MakeCursor() const
+{
+    return Cursor(source_.MakeCursor(), step_);
+}
+
+//----------------------------ZipView------------------------------------------------
+
+template <typename Left, typename Right>
+class ZipView : public ViewBase<ZipView<Left, Right>>
+{
+    using LeftCursor = decltype(std::declval<const Left&>().MakeCursor());
+    using RightCursor = decltype(std::declval<const Right&>().MakeCursor());
+
+public:
+    using value_type = std::pair<typename Left::value_type, typename Right::value_type>;
+    static constexpr bool kKnownSize = Left::kKnownSize && Right::kKnownSize;
+
+    class Cursor
+    {
+    public:
+        Cursor(LeftCursor left, RightCursor right);
+
+        bool Valid() const;
+        value_type Get() const;
+        void Advance();
+
+    private:
+        LeftCursor left_;
+        RightCursor right_;
+    };
+
+    ZipView(Left left, Right right);
+
+    size_t Size() const;
+    Cursor MakeCursor() const;
+
+private:
+    Left left_;
+    Right right_;
+};
+
+template<typename Left, typename Right>
+inline ZipView<Left, Right>::Cursor::Cursor(LeftCursor left, RightCursor right)
+    : left_(std::move(left))
+    , right_(std::move(right))
+{}
+
+template<typename Left, typename Right>
+inline bool ZipView<Left, Right>::Cursor::Valid() const
+{
+    return left_.Valid() && right_.Valid();
+}
+
+template<typename Left, typename Right>
+inline typename ZipView<Left, Right>::value_type ZipView<Left, Right>::Cursor::Get() const
+{
+    return value_type(left_.Get(), right_.Get());
+}
+
+template<typename Left, typename Right>
+inline void ZipView<Left, Right>::Cursor::Advance()
+{
+    left_.Advance();
+    right_.Advance();
+}
+
+template<typename Left, typename Right>
+inline ZipView<Left, Right>::ZipView(Left left, Right right)
+    : left_(std::move(left))
+    , right_(std::move(right))
+{}
+
+template<typename Left, typename Right>
+inline size_t ZipView<Left, Right>::Size() const
+{
+    return std::min(left_.Size(), right_.Size());
+}
+
+template<typename Left, typename Right>
+inline typename ZipView<Left, Right>::Cursor ZipView<Left, Right>::MakeCursor() const
+{
+    return Cursor(left_.MakeCursor(), right_.MakeCursor());
+}
+
+//----------------------------ChunkView------------------------------------------------
+
+// Splits contiguous storage into VectorRange pieces of chunk_size elements
+// (the last one may be shorter), so chunks are themselves views.
+template <typename T>
+class ChunkView : public ViewBase<ChunkView<T>>
+{
+public:
+    using value_type = VectorRange<T>;
+    static constexpr bool kKnownSize = true;
+
+    class Cursor
+    {
+    public:
+        Cursor(const T* current, const T* last, size_t chunk_size) noexcept;
+
+        bool Valid() const noexcept;
+        VectorRange<T> Get() const noexcept;
+        void Advance() noexcept;
+
+    private:
+        const T* current_;
+        const T* last_;
+        size_t chunk_size_;
+    };
+
+    ChunkView(VectorRange<T> source, size_t chunk_size);
+
+    size_t Size() const noexcept;
+    Cursor MakeCursor() const noexcept;
+
+private:
+    VectorRange<T> source_;
+    size_t chunk_size_;
+};
+
+template<typename T>
+inline ChunkView<T>::Cursor::Cursor(const T* current, const T* last, size_t chunk_size) noexcept
+    : current_(current)
+    , last_(last)
+    , chunk_size_(chunk_size)
+{}
+
+template<typename T>
+inline bool ChunkView<T>::Cursor::Valid() const noexcept
+{
+    return current_ != last_;
+}
+
+template<typename T>
+inline VectorRange<T> ChunkView<T>::Cursor::Get() const noexcept
+{
+    return VectorRange<T>(current_, current_ + std::min<size_t>(chunk_size_, last_ - current_));
+}
+
+template<typename T>
+inline void ChunkView<T>::Cursor::Advance() noexcept
+{
+    current_ += std::min<size_t>(chunk_size_, last_ - current_);
+}
+
+template<typename T>
+inline ChunkView<T>::ChunkView(VectorRange<T> source, size_t chunk_size)
+    : source_(source)
+    , chunk_size_(chunk_size)
+{
+    assert(chunk_size_ != 0);
+}
+
+template<typename T>
+inline size_t ChunkView<T>::Size() const noexcept
+{
+    return (source_.Size() + chunk_size_ - 1) / chunk_size_;
+}
+
+template<typename T>
+inline typename ChunkView<T>::Cursor ChunkView<T>::MakeCursor() const noexcept
+{
+    return Cursor(source_.begin(), source_.end(), chunk_size_);
+}
+
+//----------------------------ViewBase------------------------------------------------
+
+template<typename Derived>
+template<typename F>
+inline MapView<Derived, F> ViewBase<Derived>::Map(F func) const
+{
+    return MapView<Derived, F>(Self(), std::move(func));
+}
+
+template<typename Derived>
+template<typename Pred>
+inline FilterView<Derived, Pred> ViewBase<Derived>::Filter(Pred pred) const
+{
+    return FilterView<Derived, Pred>(Self(), std::move(pred));
+}
+
+template<typename Derived>
+inline TakeView<Derived> ViewBase<Derived>::Take(size_t count) const
+{
+    return TakeView<Derived>(Self(), count);
+}
+
+template<typename Derived>
+inline StrideView<Derived> ViewBase<Derived>::Stride(size_t step) const
+{
+    return StrideView<Derived>(Self(), step);
+}
+
+template<typename Derived>
+template<typename Other>
+inline ZipView<Derived, Other> ViewBase<Derived>::Zip(const Other& other) const
+{
+    return ZipView<Derived, Other>(Self(), other);
+}
+
+template<typename Derived>
+template<typename F>
+inline void ViewBase<Derived>::ForEach(F&& func) const
+{
+    for (auto cursor = Self().MakeCursor(); cursor.Valid(); cursor.Advance())
+    {
+        func(cursor.Get());
+    }
+}
+
+template<typename Derived>
+template<typename Result>
+inline auto ViewBase<Derived>::Collect() const
+{
+    using Element = std::conditional_t<std::is_void_v<Result>, typename Derived::value_type, Result>;
+    Vector<Element> result;
+    if constexpr (Derived::kKnownSize)
+    {
+        result.Reserve(Self().Size());
+    }
+    for (auto cursor = Self().MakeCursor(); cursor.Valid(); cursor.Advance())
+    {
+        result.EmplaceBack(cursor.Get());
+    }
+    return result;
+}
+
+template<typename Derived>
+inline const Derived& ViewBase<Derived>::Self() const noexcept
+{
+    return static_cast<const Derived&>(*this);
+}